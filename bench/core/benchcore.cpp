@@ -0,0 +1,362 @@
+#include "benchcore.h"
+#include "mainwindow.h"
+#include "stream.h"
+#include "twitchstream.h"
+#include "streamtee.h"
+#include "configpath.h"
+#include "followimporter.h"
+#include "streamfilter.h"
+#include "streamlist.h"
+#include "standinapi.h"
+#include <QtTest>
+#include <QApplication>
+#include <QTreeWidget>
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define TEE_BENCH_SIZE (256 * 1024 * 1024)
+#define FOLLOWS_BENCH_LATENCY 20 // ms per API response
+#define FILTER_BENCH_STREAMS 20000
+
+void BenchCore::initTestCase()
+{
+	QVERIFY(m_configDir.isValid());
+
+	// must happen before anything resolves the config path, keep polls off the network
+	qputenv(CONFIG_DIR_ENV, QFile::encodeName(m_configDir.path()));
+	qputenv(TWITCH_API_ENV, "http://127.0.0.1:1");
+}
+
+void BenchCore::createStreamItem_data()
+{
+	QTest::addColumn<QString>("url");
+
+	QTest::newRow("twitch") << "http://www.twitch.tv/SomeChannel";
+	QTest::newRow("twitch_path") << "https://twitch.tv/somechannel/profile";
+	QTest::newRow("invalid") << "not an url";
+	QTest::newRow("unsupported") << "http://www.example.com/somechannel";
+}
+
+void BenchCore::createStreamItem()
+{
+	QFETCH(QString, url);
+
+	QTreeWidget tree;
+	QTreeWidgetItem* group = new QTreeWidgetItem(&tree);
+
+	QBENCHMARK {
+		try {
+			delete ::createStreamItem(group, url, "best");
+		}
+		catch(StreamException&) {
+		}
+	}
+}
+
+void BenchCore::sortStreams_data()
+{
+	QTest::addColumn<int>("count");
+	QTest::addColumn<int>("column");
+
+	for(int count : { 100, 1000, 10000 }) {
+		QTest::newRow(qPrintable(QString("name_%1").arg(count))) << count << (int)StreamItem::COLUMN_NAME;
+		QTest::newRow(qPrintable(QString("viewers_%1").arg(count))) << count << (int)StreamItem::COLUMN_VIEWERS;
+	}
+}
+
+void BenchCore::sortStreams()
+{
+	QFETCH(int, count);
+	QFETCH(int, column);
+
+	QTreeWidget tree;
+	tree.setColumnCount(4);
+	tree.sortByColumn(column, Qt::DescendingOrder); // operator< reads the sort column
+	QTreeWidgetItem* group = new QTreeWidgetItem(&tree);
+
+	QVector<QTreeWidgetItem*> items;
+	qsrand(count);
+	for(int i = 0; i < count; i++) {
+		StreamItem* stream = ::createStreamItem(group, QString("http://www.twitch.tv/channel%1").arg(qrand()), "best");
+		stream->setText(StreamItem::COLUMN_VIEWERS, QString::number(qrand() % 50000));
+		items.append(stream);
+	}
+
+	QBENCHMARK {
+		QVector<QTreeWidgetItem*> sorted = items;
+		std::sort(sorted.begin(), sorted.end(), [](QTreeWidgetItem* a, QTreeWidgetItem* b) {
+			return *a < *b;
+		});
+	}
+
+	qDeleteAll(items);
+}
+
+void BenchCore::filterQuery_data()
+{
+	QTest::addColumn<QString>("query");
+
+	QTest::newRow("word") << "nel12";
+	QTest::newRow("words") << "chan 12 34";
+	QTest::newRow("short") << "12";
+	QTest::newRow("viewers") << ">1000 <5000";
+	QTest::newRow("word_viewers") << "nel1 >25000";
+}
+
+void BenchCore::filterQuery()
+{
+	QFETCH(QString, query);
+
+	QTreeWidget tree;
+	tree.setColumnCount(4);
+	QTreeWidgetItem* group = new QTreeWidgetItem(&tree);
+	StreamFilter filter;
+
+	qsrand(FILTER_BENCH_STREAMS);
+	for(int i = 0; i < FILTER_BENCH_STREAMS; i++) {
+		StreamItem* stream = ::createStreamItem(group, QString("http://www.twitch.tv/channel%1").arg(qrand()), "best");
+		stream->setStatus(true, qrand() % 50000);
+		filter.insert(stream);
+	}
+
+	// typing the query into an empty filter, then clearing it again
+	QBENCHMARK {
+		filter.setQuery(query);
+		filter.apply();
+		filter.setQuery("");
+		filter.apply();
+	}
+}
+
+void BenchCore::parseStatus_data()
+{
+	QTest::addColumn<QByteArray>("json");
+	QTest::addColumn<bool>("valid");
+
+	QTest::newRow("online") << QByteArray("{\"stream\":{\"_id\":1,\"game\":\"Something\",\"viewers\":1234,"
+										 "\"channel\":{\"name\":\"somechannel\",\"status\":\"Title\"}},"
+										 "\"_links\":{\"self\":\"https://api.twitch.tv/kraken/streams/somechannel\"}}") << true;
+	QTest::newRow("offline") << QByteArray("{\"stream\":null,\"_links\":{\"self\":\"https://api.twitch.tv/kraken/streams/somechannel\"}}") << true;
+	QTest::newRow("invalid") << QByteArray("<html>502 Bad Gateway</html>") << false;
+}
+
+void BenchCore::parseStatus()
+{
+	QFETCH(QByteArray, json);
+	QFETCH(bool, valid);
+
+	bool online;
+	int viewerCount;
+
+	QCOMPARE(TwitchStreamItem::parseStatus(json, &online, &viewerCount), valid);
+
+	QBENCHMARK {
+		TwitchStreamItem::parseStatus(json, &online, &viewerCount);
+	}
+}
+
+void BenchCore::parseOutputLine_data()
+{
+	QTest::addColumn<QString>("line");
+
+	QTest::newRow("qualities") << "[cli][info] Available streams: audio, high, low, medium, mobile (worst), source (best)";
+	QTest::newRow("info") << "[cli][info] Opening stream: source (hls)";
+	QTest::newRow("error") << "error: No streams found on this URL: twitch.tv/somechannel";
+}
+
+void BenchCore::parseOutputLine()
+{
+	QFETCH(QString, line);
+
+	QTreeWidget tree;
+	QTreeWidgetItem* group = new QTreeWidgetItem(&tree);
+	StreamItem* stream = ::createStreamItem(group, "http://www.twitch.tv/somechannel", "best");
+
+	// parsing only, the log write is file I/O and would be measured with it
+	QBENCHMARK {
+		stream->parseOutputLine(line);
+	}
+
+	delete stream;
+}
+
+void BenchCore::streamListRoundTrip_data()
+{
+	QTest::addColumn<int>("count");
+
+	for(int count : { 100, 1000, 10000 }) {
+		QTest::newRow(qPrintable(QString::number(count))) << count;
+	}
+}
+
+void BenchCore::streamListRoundTrip()
+{
+	QFETCH(int, count);
+
+	QString path = CONFIG_PATH + "/" + STREAM_SAVE_FILENAME;
+
+	{
+		QFile file(path);
+		QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+
+		QTextStream out(&file);
+		for(int i = 0; i < count; i++) {
+			out << "http://www.twitch.tv/channel" << i << " best\n";
+		}
+	}
+
+	// what loadStreams() and saveStreams() do with the file
+	QVector<StreamListGroup> groups;
+
+	QBENCHMARK {
+		groups.clear();
+		QVERIFY(readStreamList(path, &groups));
+		QVERIFY(writeStreamList(path, groups));
+	}
+
+	groups.clear();
+	QVERIFY(readStreamList(path, &groups));
+	QCOMPARE(groups.size(), 1);
+	QCOMPARE(groups.first().streams.size(), count);
+}
+
+#ifdef Q_OS_UNIX
+/**
+ * @brief Writes a fixed amount into a fifo, or drains one until EOF
+ */
+class FifoPump : public QThread
+{
+	QString m_path;
+	qint64 m_writeSize;
+
+protected:
+	void run()
+	{
+		static char buffer[64 * 1024];
+
+		if(m_writeSize > 0) {
+			int fd = ::open(QFile::encodeName(m_path).constData(), O_WRONLY);
+			for(qint64 written = 0; written < m_writeSize; ) {
+				ssize_t n = ::write(fd, buffer, sizeof(buffer));
+				if(n <= 0)
+					break;
+				written += n;
+			}
+			::close(fd);
+		}
+		else {
+			char drain[64 * 1024];
+			int fd = ::open(QFile::encodeName(m_path).constData(), O_RDONLY);
+			while(::read(fd, drain, sizeof(drain)) > 0) {}
+			::close(fd);
+		}
+	}
+
+public:
+	FifoPump(QString const& path, qint64 writeSize) : m_path(path), m_writeSize(writeSize) {}
+};
+#endif
+
+void BenchCore::teeThroughput()
+{
+#ifdef Q_OS_UNIX
+	QString base = m_configDir.path() + "/tee";
+	StreamTee tee(base + ".in", base + ".out", base + ".ts");
+	QVERIFY(tee.createFifos());
+
+	FifoPump livestreamer(tee.getInputPath(), TEE_BENCH_SIZE);
+	FifoPump player(tee.getPlayerPath(), 0);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	tee.start();
+	livestreamer.start();
+	player.start();
+
+	livestreamer.wait();
+	tee.wait();
+	player.wait();
+
+	qint64 ms = qMax<qint64>(timer.elapsed(), 1);
+
+	QCOMPARE(tee.bytesTransferred(), (qint64)TEE_BENCH_SIZE);
+	QCOMPARE(QFileInfo(base + ".ts").size(), (qint64)TEE_BENCH_SIZE);
+
+	QTest::setBenchmarkResult(TEE_BENCH_SIZE * 1000.0 / ms, QTest::BytesPerSecond);
+	QFile::remove(base + ".ts");
+#else
+	QSKIP("StreamTee needs fifos");
+#endif
+}
+
+void BenchCore::followImport_data()
+{
+	QTest::addColumn<int>("follows");
+	QTest::addColumn<int>("concurrency");
+
+	for(int follows : { 100, 1000 }) {
+		for(int concurrency : { 1, FOLLOWS_CONCURRENCY }) {
+			QTest::newRow(qPrintable(QString("%1_x%2").arg(follows).arg(concurrency))) << follows << concurrency;
+		}
+	}
+}
+
+void BenchCore::followImport()
+{
+	QFETCH(int, follows);
+	QFETCH(int, concurrency);
+
+	StandInApi api;
+	api.setFollowCount(follows);
+	api.setLatency(FOLLOWS_BENCH_LATENCY);
+	QVERIFY(api.listenLocal());
+
+	QStringList urls;
+
+	QBENCHMARK {
+		FollowImporter importer("someone", api.url());
+		importer.setConcurrency(concurrency);
+
+		QSignalSpy spy(&importer, SIGNAL(finished(QStringList)));
+		importer.start();
+		QVERIFY(spy.wait(30000));
+
+		urls = spy.first().first().toStringList();
+	}
+
+	// every page, in follow order
+	QCOMPARE(urls.size(), follows);
+	QCOMPARE(urls.last(), QString("http://www.twitch.tv/follow%1").arg(follows - 1));
+
+	// the batch insert drops the ones already in the list
+	MainWindow w;
+
+	int duplicates;
+	QCOMPARE(w.importStreamUrls(urls.mid(0, follows / 2), QString(), &duplicates), follows / 2);
+	QCOMPARE(w.importStreamUrls(urls, QString(), &duplicates), follows - follows / 2);
+	QCOMPARE(duplicates, follows / 2);
+}
+
+int main(int argc, char *argv[])
+{
+	QApplication app(argc, argv);
+	BenchCore bench;
+
+	// machine-readable results by default, so runs can be compared between builds
+	QStringList args = app.arguments();
+	if(!args.contains("-o")) {
+		args << "-o" << "bench-core.xml,xml" << "-o" << "-,txt";
+	}
+
+	return QTest::qExec(&bench, args);
+}
@@ -0,0 +1,40 @@
+#ifndef BENCHCORE_H
+#define BENCHCORE_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class BenchCore : public QObject
+{
+	Q_OBJECT
+
+	QTemporaryDir m_configDir;
+
+private slots:
+	void initTestCase();
+
+	void createStreamItem_data();
+	void createStreamItem();
+
+	void sortStreams_data();
+	void sortStreams();
+
+	void filterQuery_data();
+	void filterQuery();
+
+	void parseStatus_data();
+	void parseStatus();
+
+	void parseOutputLine_data();
+	void parseOutputLine();
+
+	void streamListRoundTrip_data();
+	void streamListRoundTrip();
+
+	void teeThroughput();
+
+	void followImport_data();
+	void followImport();
+};
+
+#endif // BENCHCORE_H
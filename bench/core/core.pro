@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Micro-benchmarks for the core hot paths
+# Results are written to bench-core.xml unless -o is given
+#
+#-------------------------------------------------
+
+TARGET = bench-core
+TEMPLATE = app
+QT += testlib
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../sources.pri)
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += benchcore.cpp \
+    ../standinapi.cpp
+
+HEADERS += benchcore.h \
+    ../standinapi.h
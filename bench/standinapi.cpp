@@ -0,0 +1,110 @@
+#include "standinapi.h"
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QList>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QTimer>
+
+StandInApi::StandInApi(QObject* parent)
+	: QTcpServer(parent)
+{
+	m_requestCount = 0;
+	m_followCount = 0;
+	m_latency = 0;
+	connect(this, &QTcpServer::newConnection, this, &StandInApi::onNewConnection);
+}
+
+bool StandInApi::listenLocal()
+{
+	return listen(QHostAddress::LocalHost, 0);
+}
+
+QString StandInApi::url() const
+{
+	return QString("http://127.0.0.1:%1").arg(serverPort());
+}
+
+int StandInApi::requestCount() const
+{
+	return m_requestCount;
+}
+
+void StandInApi::setFollowCount(int count)
+{
+	m_followCount = count;
+}
+
+void StandInApi::setLatency(int ms)
+{
+	m_latency = ms;
+}
+
+QByteArray StandInApi::respond(const QByteArray& path)
+{
+	if(path.startsWith("/users/") && path.contains("/follows/channels")) {
+		QUrlQuery query(QUrl::fromEncoded(path));
+		int limit = query.queryItemValue("limit").toInt();
+		int offset = query.queryItemValue("offset").toInt();
+
+		QByteArray follows;
+		for(int i = offset; i < qMin(offset + limit, m_followCount); i++) {
+			if(!follows.isEmpty())
+				follows += ",";
+			follows += "{\"channel\":{\"name\":\"follow" + QByteArray::number(i) + "\"}}";
+		}
+
+		return "{\"_total\":" + QByteArray::number(m_followCount) + ",\"follows\":[" + follows + "]}";
+	}
+
+	QByteArray name = path.mid(path.lastIndexOf('/') + 1);
+	name = name.left(name.indexOf('?'));
+
+	if(path.startsWith("/streams/")) {
+		if(qHash(name) % 2)
+			return "{\"stream\":null}";
+		return "{\"stream\":{\"viewers\":" + QByteArray::number(qHash(name) % 10000) + "}}";
+	}
+
+	return QByteArray();
+}
+
+void StandInApi::onNewConnection()
+{
+	while(hasPendingConnections()) {
+		QTcpSocket* socket = nextPendingConnection();
+		connect(socket, &QTcpSocket::readyRead, this, &StandInApi::onReadyRead);
+		connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+		connect(socket, &QObject::destroyed, this, [this, socket]() { m_requests.remove(socket); });
+	}
+}
+
+void StandInApi::onReadyRead()
+{
+	QTcpSocket* socket = static_cast<QTcpSocket*>(sender());
+	QByteArray& request = m_requests[socket];
+	request += socket->readAll();
+
+	// keep-alive: answer every complete request in the buffer
+	int end;
+	while((end = request.indexOf("\r\n\r\n")) != -1) {
+		QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+		request.remove(0, end + 4);
+		m_requestCount++;
+
+		QByteArray body;
+		if(requestLine.size() > 1)
+			body = respond(requestLine[1]);
+
+		QByteArray status = body.isEmpty() ? "404 Not Found" : "200 OK";
+		QByteArray response = "HTTP/1.1 " + status + "\r\n"
+							  "Content-Type: application/json\r\n"
+							  "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+							  "\r\n" + body;
+
+		if(m_latency > 0)
+			QTimer::singleShot(m_latency, socket, [socket, response]() { socket->write(response); });
+		else
+			socket->write(response);
+	}
+}
@@ -0,0 +1,44 @@
+#ifndef STANDINAPI_H
+#define STANDINAPI_H
+
+#include <QTcpServer>
+#include <QHash>
+#include <QByteArray>
+
+class QTcpSocket;
+
+/**
+ * @brief Minimal local stand-in for the Twitch API, used by the benchmarks
+ *
+ * Point the app at it with LIVESTREAMERUI_TWITCH_API=url().
+ * /streams/<name> answers online with a few viewers for every other name.
+ * /users/<user>/follows/channels pages through followCount() channels
+ * named follow0, follow1, ...
+ */
+class StandInApi : public QTcpServer
+{
+	Q_OBJECT
+
+	QHash<QTcpSocket*, QByteArray> m_requests;
+	int m_requestCount;
+	int m_followCount;
+	int m_latency;
+
+	QByteArray respond(QByteArray const& path);
+
+private slots:
+	void onNewConnection();
+	void onReadyRead();
+
+public:
+	explicit StandInApi(QObject* parent = nullptr);
+
+	bool listenLocal();
+	QString url() const;
+	int requestCount() const;
+
+	void setFollowCount(int count);
+	void setLatency(int ms); // delay before each response, to make round trips count
+};
+
+#endif // STANDINAPI_H
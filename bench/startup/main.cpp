@@ -0,0 +1,115 @@
+#include "mainwindow.h"
+#include "configpath.h"
+#include "twitchstream.h"
+#include "standinapi.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QProcess>
+#include <QEventLoop>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+#include <cstdio>
+
+#define BENCH_TIMEOUT (5 * 60 * 1000)
+
+/**
+ * Without arguments: start a stand-in API, then run this executable once per list size
+ * (so every measurement is a real cold start) and print the results as CSV.
+ * With "--streams N": measure one startup against the config folder and API from the environment.
+ */
+
+static int runOnce(int argc, char *argv[], int streamCount)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	Q_INIT_RESOURCE(app);
+
+	QApplication a(argc, argv);
+
+	qint64 firstPaint = -1;
+	qint64 allStatuses = -1;
+
+	MainWindow w;
+	QObject::connect(&w, &MainWindow::firstPaint, [&]() {
+		firstPaint = timer.elapsed();
+	});
+	QObject::connect(&w, &MainWindow::streamsUpdated, [&]() {
+		allStatuses = timer.elapsed();
+		a.quit();
+	});
+
+	QTimer::singleShot(BENCH_TIMEOUT, &a, SLOT(quit()));
+
+	w.show();
+	a.exec();
+
+	printf("%d,%lld,%lld\n", streamCount, firstPaint, allStatuses);
+	return allStatuses < 0 ? 1 : 0;
+}
+
+static bool writeStreamList(QString const& dir, int streamCount)
+{
+	QFile file(dir + "/" + STREAM_SAVE_FILENAME);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+
+	QTextStream out(&file);
+	for(int i = 0; i < streamCount; i++) {
+		out << "http://www.twitch.tv/bench" << i << " best\n";
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc > 2 && QString(argv[1]) == "--streams") {
+		return runOnce(argc, argv, QString(argv[2]).toInt());
+	}
+
+	QCoreApplication a(argc, argv);
+
+	StandInApi api;
+	if(!api.listenLocal()) {
+		fprintf(stderr, "failed to start the stand-in API\n");
+		return 1;
+	}
+
+	printf("streams,first_paint_ms,all_statuses_ms\n");
+	fflush(stdout);
+
+	int result = 0;
+	for(int streamCount : { 100, 1000, 10000 }) {
+		QTemporaryDir configDir;
+		if(!configDir.isValid() || !writeStreamList(configDir.path(), streamCount)) {
+			fprintf(stderr, "failed to create the config folder\n");
+			return 1;
+		}
+
+		QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+		env.insert(CONFIG_DIR_ENV, configDir.path());
+		env.insert(TWITCH_API_ENV, api.url());
+
+		QProcess child;
+		child.setProcessEnvironment(env);
+		child.setProcessChannelMode(QProcess::ForwardedChannels);
+
+		// keep serving the API while the child runs
+		QEventLoop loop;
+		QObject::connect(&child, SIGNAL(finished(int)), &loop, SLOT(quit()));
+		child.start(QCoreApplication::applicationFilePath(), QStringList() << "--streams" << QString::number(streamCount));
+		if(!child.waitForStarted()) {
+			fprintf(stderr, "failed to start the benchmark process\n");
+			return 1;
+		}
+		loop.exec();
+
+		if(child.exitCode() != 0)
+			result = 1;
+	}
+
+	return result;
+}
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Cold-start benchmark: time to first paint and time
+# until every stream has a status, for 100/1k/10k streams
+#
+#-------------------------------------------------
+
+TARGET = bench-startup
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../sources.pri)
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += main.cpp \
+    ../standinapi.cpp
+
+HEADERS += ../standinapi.h
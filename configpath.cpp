@@ -1,5 +1,11 @@
 #include "configpath.h"
 #include <QStandardPaths>
 
-static const QString g_configPath(QStandardPaths::locate(QStandardPaths::DocumentsLocation, QString(), QStandardPaths::LocateDirectory)
-						  + "/" + CONFIG_DIR_NAME);
+const QString& configPath()
+{
+	static const QString path = qEnvironmentVariableIsSet(CONFIG_DIR_ENV)
+			? QString::fromLocal8Bit(qgetenv(CONFIG_DIR_ENV))
+			: QStandardPaths::locate(QStandardPaths::DocumentsLocation, QString(), QStandardPaths::LocateDirectory)
+			  + "/" + CONFIG_DIR_NAME;
+	return path;
+}
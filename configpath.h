@@ -4,9 +4,15 @@
 #include <QString>
 
 #define CONFIG_DIR_NAME "LivestreamerUI"
+#define CONFIG_DIR_ENV "LIVESTREAMERUI_CONFIG_DIR"
 #define STREAM_SAVE_FILENAME "streams.list"
 #define SETTINGS_FILENAME "settings.cfg"
-extern const QString g_configPath;
-#define CONFIG_PATH g_configPath
+#define RECORD_DIR_NAME "recordings"
+
+/**
+ * @brief Config folder, resolved on first use (can be overridden with LIVESTREAMERUI_CONFIG_DIR)
+ */
+const QString& configPath();
+#define CONFIG_PATH configPath()
 
 #endif
@@ -0,0 +1,109 @@
+#include "followimporter.h"
+#include "twitchstream.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QUrl>
+
+#define FOLLOW_URL "http://www.twitch.tv/"
+
+FollowImporter::FollowImporter(const QString& user, const QString& apiUrl, QObject* parent)
+	: QObject(parent),
+	  m_tasks(this)
+{
+	m_user = user;
+	m_apiUrl = apiUrl;
+	m_concurrency = FOLLOWS_CONCURRENCY;
+	m_total = -1;
+	m_nextOffset = 0;
+	m_received = 0;
+}
+
+void FollowImporter::setConcurrency(int pages)
+{
+	m_concurrency = qMax(pages, 1);
+}
+
+void FollowImporter::start()
+{
+	cancel();
+
+	// the total is only known from the first page
+	request(0);
+	m_nextOffset = FOLLOWS_PAGE_SIZE;
+}
+
+void FollowImporter::cancel()
+{
+	m_tasks.cancel();
+	m_pages.clear();
+	m_total = -1;
+	m_nextOffset = 0;
+	m_received = 0;
+}
+
+void FollowImporter::request(int offset)
+{
+	// the name is typed by the user, it must stay one path segment
+	QString user = QString::fromLatin1(QUrl::toPercentEncoding(m_user));
+
+	QUrl url(m_apiUrl + "/users/" + user + "/follows/channels");
+	url.setQuery(QString("limit=%1&offset=%2&client_id=%3").arg(FOLLOWS_PAGE_SIZE).arg(offset).arg(TWITCH_CLIENT_ID));
+
+	m_tasks.get(QNetworkRequest(url), [this, offset](QNetworkReply* reply) { onPage(offset, reply); });
+}
+
+void FollowImporter::onPage(int offset, QNetworkReply* reply)
+{
+	if(reply->error() != QNetworkReply::NoError) {
+		if(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 404)
+			fail("User " + m_user + " not found.");
+		else
+			fail(reply->errorString());
+		return;
+	}
+
+	QJsonObject root = QJsonDocument::fromJson(reply->readAll()).object();
+	if(!root.value("follows").isArray()) {
+		fail("Invalid follows response.");
+		return;
+	}
+
+	QStringList urls;
+	for(auto value : root.value("follows").toArray()) {
+		QString name = value.toObject().value("channel").toObject().value("name").toString();
+		if(!name.isEmpty())
+			urls.append(FOLLOW_URL + name);
+	}
+
+	m_pages.insert(offset, urls);
+	m_received += urls.size();
+
+	if(m_total < 0)
+		m_total = root.value("_total").toInt();
+
+	emit progress(m_received, m_total);
+
+	// keep the limit of pages in flight until every offset is requested
+	while(m_tasks.pending() < m_concurrency && m_nextOffset < m_total) {
+		request(m_nextOffset);
+		m_nextOffset += FOLLOWS_PAGE_SIZE;
+	}
+
+	if(m_tasks.pending() > 0)
+		return;
+
+	QStringList all;
+	for(auto const& page : m_pages) {
+		all += page;
+	}
+	m_pages.clear();
+
+	emit finished(all);
+}
+
+void FollowImporter::fail(const QString& errorTxt)
+{
+	cancel();
+	emit failed(errorTxt);
+}
@@ -0,0 +1,51 @@
+#ifndef FOLLOWIMPORTER_H
+#define FOLLOWIMPORTER_H
+
+#include <QObject>
+#include <QMap>
+#include <QStringList>
+#include "taskscope.h"
+
+#define FOLLOWS_PAGE_SIZE 100 // the API maximum
+#define FOLLOWS_CONCURRENCY 4 // pages in flight at once
+
+/**
+ * @brief Fetches the channels a Twitch user follows, as stream urls
+ *
+ * The first page gives the total, the remaining pages are then requested
+ * in parallel, up to the concurrency limit. The urls come out in follow
+ * order once every page has arrived.
+ */
+class FollowImporter : public QObject
+{
+	Q_OBJECT
+
+	QString m_user;
+	QString m_apiUrl;
+	int m_concurrency;
+
+	TaskScope m_tasks;
+	int m_total; // -1 until the first page arrived
+	int m_nextOffset;
+	int m_received;
+	QMap<int, QStringList> m_pages; // by offset
+
+	void request(int offset);
+	void onPage(int offset, QNetworkReply* reply);
+	void fail(QString const& errorTxt);
+
+signals:
+	void progress(int received, int total);
+	void finished(QStringList const& urls);
+	void failed(QString const& errorTxt);
+
+public:
+	FollowImporter(QString const& user, QString const& apiUrl, QObject* parent = nullptr);
+
+	void setConcurrency(int pages);
+
+	void start();
+	void cancel(); // neither finished() nor failed() follows
+};
+
+#endif // FOLLOWIMPORTER_H
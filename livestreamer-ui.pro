@@ -4,27 +4,11 @@
 #
 #-------------------------------------------------
 
-QT       += core gui network
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
 TARGET = livestreamer-ui
 TEMPLATE = app
 
+include(sources.pri)
 
-SOURCES += main.cpp \
-    stream.cpp \
-    twitchstream.cpp \
-    configpath.cpp
-SOURCES += mainwindow.cpp
-
-HEADERS += mainwindow.h \
-    stream.h \
-    twitchstream.h \
-    configpath.h
-
-FORMS += mainwindow.ui
-
-RESOURCES = app.qrc
+SOURCES += main.cpp
 
 RC_ICONS = icons/app-ico64.ico
@@ -0,0 +1,286 @@
+#include "logviewer.h"
+#include <QApplication>
+#include <QListView>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QByteArrayMatcher>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+
+#define SEARCH_CHUNK_SIZE (64 * 1024 * 1024) // QByteArrayMatcher takes int lengths
+
+LogModel::LogModel(QObject* parent)
+	: QAbstractListModel(parent)
+{
+	m_data = nullptr;
+	m_size = 0;
+	m_level = LEVEL_ALL;
+}
+
+void LogModel::setBuffer(const char* data, qint64 size)
+{
+	beginResetModel();
+
+	m_data = data;
+	m_size = size;
+	m_lineStarts.clear();
+	m_warningRows.clear();
+	m_errorRows.clear();
+	m_level = LEVEL_ALL;
+
+	// one pass over the mapping, the offsets and the level rows are kept
+	qint64 pos = 0;
+	while(pos < size) {
+		int line = m_lineStarts.size();
+		m_lineStarts.append(pos);
+
+		const void* nl = memchr(data + pos, '\n', size - pos);
+		qint64 end = nl ? static_cast<const char*>(nl) - data + 1 : size;
+
+		Level level = lineLevel(pos, end);
+		if(level != LEVEL_ALL)
+			m_warningRows.append(line);
+		if(level == LEVEL_ERROR)
+			m_errorRows.append(line);
+
+		pos = end;
+	}
+
+	endResetModel();
+}
+
+LogModel::Level LogModel::lineLevel(qint64 start, qint64 end) const
+{
+	static const QByteArrayMatcher errorTag("[error]");
+	static const QByteArrayMatcher warningTag("[warning]");
+
+	QByteArray const text = QByteArray::fromRawData(m_data + start, end - start);
+
+	// "[cli][error] ...", or livestreamer's own "error: ..." on exit
+	if(errorTag.indexIn(text) >= 0 || text.startsWith("error: "))
+		return LEVEL_ERROR;
+
+	return warningTag.indexIn(text) >= 0 ? LEVEL_WARNING : LEVEL_ALL;
+}
+
+const QVector<int>& LogModel::rows() const
+{
+	return m_level == LEVEL_ERROR ? m_errorRows : m_warningRows;
+}
+
+void LogModel::setLevel(Level level)
+{
+	beginResetModel();
+	m_level = level;
+	endResetModel();
+}
+
+int LogModel::lineCount() const
+{
+	return m_lineStarts.size();
+}
+
+qint64 LogModel::lineStart(int line) const
+{
+	return line < m_lineStarts.size() ? m_lineStarts[line] : m_size;
+}
+
+QByteArray LogModel::line(int line) const
+{
+	qint64 start = lineStart(line);
+	qint64 end = lineStart(line + 1);
+
+	while(end > start && (m_data[end - 1] == '\n' || m_data[end - 1] == '\r'))
+		end--;
+
+	return QByteArray(m_data + start, end - start);
+}
+
+int LogModel::lineAt(qint64 offset) const
+{
+	auto it = std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), offset);
+	return (it - m_lineStarts.begin()) - 1;
+}
+
+int LogModel::rowForLine(int line) const
+{
+	if(m_level == LEVEL_ALL)
+		return line;
+
+	QVector<int> const& shown = rows();
+
+	auto it = std::lower_bound(shown.begin(), shown.end(), line);
+	if(it == shown.end() || *it != line)
+		return -1;
+	return it - shown.begin();
+}
+
+int LogModel::lineForRow(int row) const
+{
+	return m_level == LEVEL_ALL ? row : rows()[row];
+}
+
+int LogModel::rowCount(const QModelIndex& parent) const
+{
+	if(parent.isValid())
+		return 0;
+	return m_level == LEVEL_ALL ? m_lineStarts.size() : rows().size();
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const
+{
+	if(role != Qt::DisplayRole || !index.isValid())
+		return QVariant();
+
+	return QString::fromUtf8(line(lineForRow(index.row())));
+}
+
+
+LogViewer::LogViewer(const QString& path, QWidget* parent)
+	: QDialog(parent),
+	  m_file(path),
+	  m_model(this)
+{
+	m_data = nullptr;
+
+	setAttribute(Qt::WA_DeleteOnClose);
+	setWindowTitle(QFileInfo(path).fileName());
+	resize(640, 400);
+
+	m_view = new QListView(this);
+	m_view->setModel(&m_model);
+	m_view->setUniformItemSizes(true); // rows are laid out without measuring every line
+	m_view->setFont(QFont("Monospace"));
+
+	m_search = new QLineEdit(this);
+	m_search->setPlaceholderText("Search");
+	m_search->setClearButtonEnabled(true);
+
+	QPushButton* findButton = new QPushButton("Find next", this);
+
+	m_level = new QComboBox(this);
+	m_level->addItem("All", LogModel::LEVEL_ALL);
+	m_level->addItem("Warnings and errors", LogModel::LEVEL_WARNING);
+	m_level->addItem("Errors", LogModel::LEVEL_ERROR);
+
+	QHBoxLayout* bar = new QHBoxLayout();
+	bar->addWidget(m_search);
+	bar->addWidget(findButton);
+	bar->addWidget(m_level);
+
+	QVBoxLayout* layout = new QVBoxLayout(this);
+	layout->addLayout(bar);
+	layout->addWidget(m_view);
+
+	connect(m_search, SIGNAL(returnPressed()), this, SLOT(onFindNext()));
+	connect(findButton, SIGNAL(clicked()), this, SLOT(onFindNext()));
+	connect(m_level, SIGNAL(currentIndexChanged(int)), this, SLOT(onLevelChanged(int)));
+}
+
+LogViewer::~LogViewer()
+{
+	// the model must not outlive the mapping it points into
+	m_model.setBuffer(nullptr, 0);
+
+	if(m_data)
+		m_file.unmap(m_data);
+}
+
+bool LogViewer::open()
+{
+	if(!m_file.open(QIODevice::ReadOnly))
+		return false;
+
+	// an empty file can't be mapped, it's just an empty log
+	if(m_file.size() > 0) {
+		m_data = m_file.map(0, m_file.size());
+		if(!m_data)
+			return false;
+	}
+
+	m_model.setBuffer(reinterpret_cast<const char*>(m_data), m_file.size());
+	m_view->scrollToBottom();
+	return true;
+}
+
+qint64 LogViewer::find(const QByteArray& text, qint64 from) const
+{
+	QByteArrayMatcher matcher(text);
+	const char* data = reinterpret_cast<const char*>(m_data);
+	qint64 size = m_file.size();
+
+	// chunks overlap by the pattern length so matches across a boundary are found
+	while(from + text.size() <= size) {
+		int length = static_cast<int>(std::min<qint64>(size - from, SEARCH_CHUNK_SIZE));
+
+		int index = matcher.indexIn(data + from, length);
+		if(index >= 0)
+			return from + index;
+
+		if(from + length >= size)
+			break;
+		from += length - text.size() + 1;
+	}
+
+	return -1;
+}
+
+void LogViewer::onFindNext()
+{
+	QByteArray text = m_search->text().toUtf8();
+	if(text.isEmpty() || !m_data)
+		return;
+
+	// start after the current line, wrap around once
+	QModelIndex current = m_view->currentIndex();
+	int startLine = current.isValid() ? m_model.lineForRow(current.row()) + 1 : 0;
+	qint64 from = m_model.lineStart(startLine);
+	bool wrapped = false;
+
+	forever {
+		qint64 offset = find(text, from);
+
+		if(offset < 0 || (wrapped && offset >= m_model.lineStart(startLine))) {
+			if(wrapped || startLine == 0)
+				break;
+			wrapped = true;
+			from = 0;
+			continue;
+		}
+
+		int line = m_model.lineAt(offset);
+		int row = m_model.rowForLine(line);
+
+		// hidden by the level filter, keep looking
+		if(row < 0) {
+			from = m_model.lineStart(line + 1);
+			continue;
+		}
+
+		QModelIndex index = m_model.index(row);
+		m_view->setCurrentIndex(index);
+		m_view->scrollTo(index, QAbstractItemView::PositionAtCenter);
+		return;
+	}
+
+	QApplication::beep();
+}
+
+void LogViewer::onLevelChanged(int index)
+{
+	QModelIndex current = m_view->currentIndex();
+	int line = current.isValid() ? m_model.lineForRow(current.row()) : -1;
+
+	m_model.setLevel(static_cast<LogModel::Level>(m_level->itemData(index).toInt()));
+
+	// keep the selected line in view if the new level still shows it
+	int row = line >= 0 ? m_model.rowForLine(line) : -1;
+	if(row >= 0)
+		m_view->scrollTo(m_model.index(row), QAbstractItemView::PositionAtCenter);
+	else
+		m_view->scrollToBottom();
+}
@@ -0,0 +1,95 @@
+#ifndef LOGVIEWER_H
+#define LOGVIEWER_H
+
+#include <QDialog>
+#include <QAbstractListModel>
+#include <QFile>
+#include <QVector>
+
+class QListView;
+class QLineEdit;
+class QComboBox;
+
+/**
+ * @brief Lines of a memory-mapped log file
+ *
+ * Only the line start offsets are kept, the text of a line is decoded when the
+ * view asks for it. With a level set, the model only exposes the rows whose
+ * line carries a matching livestreamer level tag; those are collected in the
+ * same pass as the offsets, so switching levels doesn't touch the file.
+ */
+class LogModel : public QAbstractListModel
+{
+	Q_OBJECT
+
+public:
+	enum Level {
+		LEVEL_ALL,
+		LEVEL_WARNING, // warnings and errors
+		LEVEL_ERROR
+	};
+
+private:
+	const char* m_data;
+	qint64 m_size;
+	QVector<qint64> m_lineStarts;
+	QVector<int> m_warningRows; // line numbers with a warning or an error
+	QVector<int> m_errorRows;
+	Level m_level;
+
+	Level lineLevel(qint64 start, qint64 end) const; // LEVEL_ALL if the line has no tag
+	QVector<int> const& rows() const; // line numbers shown, unused for LEVEL_ALL
+
+public:
+	LogModel(QObject* parent = nullptr);
+
+	void setBuffer(const char* data, qint64 size);
+	void setLevel(Level level);
+
+	int lineCount() const;
+	QByteArray line(int line) const; // without the line break
+	int lineAt(qint64 offset) const;
+	qint64 lineStart(int line) const;
+
+	int rowForLine(int line) const; // -1 if filtered out
+	int lineForRow(int row) const;
+
+	virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+	virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+};
+
+/**
+ * @brief Read-only viewer for a stream's livestreamer log
+ *
+ * The file is mapped instead of read so opening a large log costs one pass to
+ * index the line breaks, scrolling and searching work on the mapping.
+ */
+class LogViewer : public QDialog
+{
+	Q_OBJECT
+
+	QFile m_file;
+	uchar* m_data;
+	LogModel m_model;
+
+	QListView* m_view;
+	QLineEdit* m_search;
+	QComboBox* m_level;
+
+	qint64 find(QByteArray const& text, qint64 from) const;
+
+private slots:
+	void onFindNext();
+	void onLevelChanged(int index);
+
+public:
+	LogViewer(QString const& path, QWidget* parent = nullptr);
+	~LogViewer();
+
+	/**
+	 * @brief Map the file, false if it can't be opened
+	 */
+	bool open();
+};
+
+#endif // LOGVIEWER_H
@@ -1,4 +1,5 @@
 #include "mainwindow.h"
+#include "singleinstance.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
@@ -7,7 +8,18 @@ int main(int argc, char *argv[])
 
 	QApplication a(argc, argv);
 
+	// urls given on the command line are added to the list
+	QStringList urls = a.arguments().mid(1);
+
+	SingleInstance instance;
+	if(!instance.start() && !urls.isEmpty()) {
+		// already running, hand the urls over and quit
+		return instance.sendUrls(urls) ? 0 : 1;
+	}
+
 	MainWindow w;
+	w.setInstance(&instance);
+	w.addStreamUrls(urls);
 	w.show();
 
 	return a.exec();
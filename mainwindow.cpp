@@ -1,18 +1,50 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "singleinstance.h"
+#include "logviewer.h"
+#include "followimporter.h"
+#include "twitchstream.h"
+#include "streamlist.h"
 #include <QtDebug>
+#include <QApplication>
+#include <QMenu>
 #include <QInputDialog>
 #include <QFile>
 #include <QTextStream>
 #include <QDir>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <algorithm>
+
+#define STARTUP_BATCH_SIZE 250 // streams materialized per event loop turn
+#define SNAPSHOT_DELAY 250 // ms, coalesces status changes into one snapshot
+#define TRAY_MEASURE_DELAY 1000 // ms, lets the deferred deletes of the view run first
 
 MainWindow::MainWindow(QWidget *parent) :
 	QMainWindow(parent),
 	ui(new Ui::MainWindow),
-	m_updateTimer(this)
-
+	m_updateTimer(this),
+	m_started(false),
+	m_loaded(false),
+	m_pendingIndex(0),
+	m_pollCycleSize(0),
+	m_instance(nullptr),
+	m_readOnly(false),
+	m_snapshotTimer(this),
+	m_snapshotVersion(0),
+	m_statusServer(this),
+	m_tray(nullptr),
+	m_trayPoller(this),
+	m_inTray(false),
+	m_viewReleased(false),
+	m_viewMemory(-1),
+	m_trayMemory(-1),
+	m_importer(nullptr)
 {
 	ui->setupUi(this);
 
@@ -49,49 +81,127 @@ MainWindow::MainWindow(QWidget *parent) :
 	streamList->setColumnWidth(StreamItem::COLUMN_VIEWERS, 60); // (Viewers)
 	streamList->setColumnWidth(StreamItem::COLUMN_QUALITY, 1); // (Quality)
 
-	// create the config folder
-	QDir configDir(CONFIG_PATH);
-	if (!configDir.exists()){
-	  configDir.mkdir(".");
-	}
-
 	// default settings
 	m_settings.livestreamerPath = "livestreamer";
 	m_settings.autoUpdateStreams = 0;
 	m_settings.updateInterval = 60; // 60 seconds
+	m_settings.playerPath = "vlc";
+	m_settings.recordStreams = 0;
+	m_settings.statusServerPort = 0;
+	m_settings.minimizeToTray = 0;
 
-	loadSettings();
-	loadStreams();
+	connect(&m_trayPoller, &TrayPoller::wentLive, this, &MainWindow::onTrayStreamLive);
+	connect(&m_trayPoller, &TrayPoller::statusChanged, this, &MainWindow::onTrayStatusChanged);
 
-	// get viewers and stuff
-	updateStreams();
+	connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(onUpdateTimer()));
 
-	// auto update
-	ui->actionAutoUpdateStreams->setChecked(false);
-	if(m_settings.autoUpdateStreams) {
-		ui->actionAutoUpdateStreams->setChecked(true);
-		m_updateTimer.start(m_settings.updateInterval * 1000);
-	}
+	m_snapshotTimer.setSingleShot(true);
+	m_snapshotTimer.setInterval(SNAPSHOT_DELAY);
+	connect(&m_snapshotTimer, SIGNAL(timeout()), this, SLOT(publishSnapshot()));
 
-	connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(onUpdateTimer()));
+	// sort by viewer count, sorting is enabled once the streams are materialized
+	streamList->header()->setSortIndicator(StreamItem::COLUMN_VIEWERS, Qt::DescendingOrder);
 
-	 // enable sorting by column
-	streamList->setSortingEnabled(true);
-	streamList->header()->setSortIndicator(2, Qt::DescendingOrder); // sort by viewer count
+	// everything else waits for the first paint
+	streamList->viewport()->installEventFilter(this);
 }
 
 MainWindow::~MainWindow()
 {
-	saveSettings();
-	saveStreams();
+	// don't overwrite the files with defaults if we never got to load them
+	if(m_loaded) {
+		saveSettings();
+		saveStreams();
+	}
 
 	for(auto s : m_streams) {
 		delete s;
 	}
 
+	for(auto g : m_groups) {
+		delete g;
+	}
+
 	delete ui;
 }
 
+bool MainWindow::eventFilter(QObject* watched, QEvent* event)
+{
+	if(event->type() == QEvent::Paint && watched == ui->streamList->viewport()) {
+		ui->streamList->viewport()->removeEventFilter(this);
+		emit firstPaint();
+
+		// the window is on screen, load the rest on the next event loop turn
+		QTimer::singleShot(0, this, SLOT(onStartup()));
+	}
+
+	return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::changeEvent(QEvent* event)
+{
+	if(event->type() == QEvent::WindowStateChange && isMinimized()
+	   && m_settings.minimizeToTray && QSystemTrayIcon::isSystemTrayAvailable()) {
+		// the window can't be hidden from within its state change
+		QTimer::singleShot(0, this, SLOT(enterTray()));
+	}
+
+	QMainWindow::changeEvent(event);
+}
+
+void MainWindow::setInstance(SingleInstance* instance)
+{
+	m_instance = instance;
+
+	connect(m_instance, &SingleInstance::urlsReceived, this, &MainWindow::addStreamUrls);
+	connect(m_instance, &SingleInstance::subscribed, this, &MainWindow::onInstanceSubscribed);
+	connect(m_instance, &SingleInstance::snapshotReceived, this, &MainWindow::onSnapshotReceived);
+	connect(m_instance, &SingleInstance::primaryLost, this, &MainWindow::onPrimaryLost);
+
+	// another instance polls for us
+	if(!m_instance->isPrimary())
+		setReadOnly(true);
+}
+
+void MainWindow::setReadOnly(bool readOnly)
+{
+	m_readOnly = readOnly;
+
+	if(readOnly)
+		setWindowTitle(windowTitle() + " (read-only)");
+	else
+		setWindowTitle(windowTitle().remove(" (read-only)"));
+
+	ui->actionAddStream->setEnabled(!readOnly);
+	ui->actionRemoveSelected->setEnabled(!readOnly);
+	ui->actionClearAll->setEnabled(!readOnly);
+	ui->actionAddGroup->setEnabled(!readOnly);
+	ui->actionMoveToGroup->setEnabled(!readOnly);
+	ui->actionGroupPollInterval->setEnabled(!readOnly);
+	ui->actionImportFollows->setEnabled(!readOnly);
+	ui->actionAutoUpdateStreams->setEnabled(!readOnly);
+	ui->actionStatusServer->setEnabled(!readOnly);
+	m_add->setEnabled(!readOnly);
+	m_remove->setEnabled(!readOnly);
+	m_update->setEnabled(!readOnly);
+}
+
+void MainWindow::addStreamUrls(const QStringList& urls)
+{
+	if(m_readOnly)
+		return;
+
+	// wait for the saved list (or the view, when in the tray) so duplicates are caught
+	if(!m_loaded || !m_pendingStreams.isEmpty() || m_viewReleased) {
+		m_queuedUrls += urls;
+		return;
+	}
+
+	for(auto url : urls) {
+		addStreamUrl(url);
+	}
+}
+
 void MainWindow::statusStream(const QString& msg)
 {
 	ui->statusBar->setStyleSheet("QStatusBar { color: blue; }");
@@ -122,11 +232,126 @@ void MainWindow::on_actionRemoveSelected_triggered()
 
 void MainWindow::on_actionClearAll_triggered()
 {
+	m_filter.clear();
+	m_updating.clear();
+
+	// streams not materialized yet are cleared too, their groups are about to go
+	m_pendingStreams.clear();
+	m_pendingIndex = 0;
+
 	for(auto s : m_streams) {
 		delete s;
 	}
 
 	m_streams.clear();
+
+	// keep the default group only
+	for(int i = 1; i < m_groups.size(); i++) {
+		delete m_groups[i];
+	}
+	m_groups.resize(std::min(m_groups.size(), 1));
+
+	for(auto g : m_groups) {
+		g->takeCollapsed();
+		g->updateWidgetItem();
+	}
+
+	scheduleSnapshot();
+}
+
+void MainWindow::on_actionAddGroup_triggered()
+{
+	bool ok;
+	QString name = QInputDialog::getText(this, "Add group", "Group name:", QLineEdit::Normal, "", &ok);
+
+	// brackets delimit the name in the streams file
+	name = name.remove('[').remove(']').trimmed();
+
+	if(!ok || name.isEmpty())
+		return;
+
+	if(getGroup(name, false)) {
+		statusError("Error: duplicate.");
+		return;
+	}
+
+	getGroup(name, true)->setExpanded(true);
+}
+
+void MainWindow::on_actionMoveToGroup_triggered()
+{
+	StreamItem* stream = getSelectedStream();
+	if(!stream)
+		return;
+
+	QStringList names;
+	for(auto g : m_groups) {
+		names.append(g->getName());
+	}
+
+	bool ok;
+	QString name = QInputDialog::getItem(this, "Move to group", "Group:", names, names.indexOf(getSelectedGroup()->getName()), false, &ok);
+
+	if(ok)
+		moveStream(stream, getGroup(name, false));
+}
+
+void MainWindow::on_actionGroupPollInterval_triggered()
+{
+	StreamGroup* group = getSelectedGroup();
+	if(!group)
+		return;
+
+	bool ok;
+	int interval = QInputDialog::getInt(this, "Collapsed group update interval",
+										"Update \"" + group->getName() + "\" every (seconds) while collapsed:",
+										group->getPollInterval(), 10, 60*60*24, 60, &ok);
+
+	if(ok)
+		group->setPollInterval(interval);
+}
+
+void MainWindow::on_actionViewLog_triggered()
+{
+	StreamItem* stream = getSelectedStream();
+	if(!stream)
+		return;
+
+	LogViewer* viewer = new LogViewer(stream->getLogPath(), this);
+	if(!viewer->open()) {
+		delete viewer;
+		statusError("No log for " + stream->getName() + ".");
+		return;
+	}
+
+	viewer->show();
+}
+
+void MainWindow::on_actionImportFollows_triggered()
+{
+	// a finished import waiting for the list still needs m_importGroup
+	if(m_importer || !m_importedUrls.isEmpty()) {
+		statusError("An import is already running.");
+		return;
+	}
+
+	bool ok;
+	QString user = QInputDialog::getText(this, "Import followed channels", "Twitch user name:", QLineEdit::Normal, "", &ok).trimmed();
+
+	if(!ok || user.isEmpty())
+		return;
+
+	// resolved again by name when the import is done
+	StreamGroup* group = getSelectedGroup();
+	m_importGroup = group ? group->getName() : QString();
+
+	m_importer = new FollowImporter(user, twitchApiUrl(), this);
+	connect(m_importer, &FollowImporter::progress, this, &MainWindow::onFollowsProgress);
+	connect(m_importer, &FollowImporter::finished, this, &MainWindow::onFollowsImported);
+	connect(m_importer, &FollowImporter::failed, this, &MainWindow::onFollowsFailed);
+
+	statusStream("Importing channels followed by " + user + "...");
+	m_importer->start();
 }
 
 void MainWindow::on_actionSetLivestreamerLocation_triggered()
@@ -147,6 +372,24 @@ void MainWindow::on_actionSetLivestreamerLocation_triggered()
 	}
 }
 
+void MainWindow::on_actionSetPlayerLocation_triggered()
+{
+	QFileDialog dialog(this);
+
+	dialog.setFilter(QDir::Files | QDir::Executable);
+	dialog.setDirectory(m_settings.playerPath);
+#ifdef Q_OS_WIN
+	dialog.setNameFilter(tr("Executable (*.exe)"));
+#endif
+
+	if(dialog.exec()) {
+		QStringList selected = dialog.selectedFiles();
+
+		if(selected.size() > 0)
+			m_settings.playerPath = selected.first();
+	}
+}
+
 void MainWindow::on_actionAutoUpdateStreams_triggered()
 {
 	if(ui->actionAutoUpdateStreams->isChecked()) {
@@ -159,6 +402,28 @@ void MainWindow::on_actionAutoUpdateStreams_triggered()
 	}
 }
 
+void MainWindow::on_actionRecordStreams_triggered()
+{
+	m_settings.recordStreams = ui->actionRecordStreams->isChecked() ? 1 : 0;
+}
+
+void MainWindow::on_actionStatusServer_triggered()
+{
+	bool ok;
+	int port = QInputDialog::getInt(this, "Local status server", "Serve stream status on http://127.0.0.1:<port>/streams\n(0 to disable):",
+									m_settings.statusServerPort, 0, 65535, 1, &ok);
+
+	if(ok) {
+		m_settings.statusServerPort = port;
+		startStatusServer();
+	}
+}
+
+void MainWindow::on_actionMinimizeToTray_triggered()
+{
+	m_settings.minimizeToTray = ui->actionMinimizeToTray->isChecked() ? 1 : 0;
+}
+
 void MainWindow::on_actionAboutLivestreamerUI_triggered()
 {
 	// TODO: improve this
@@ -201,6 +466,53 @@ void MainWindow::on_streamList_itemDoubleClicked(QTreeWidgetItem *item, int colu
 	watchStream();
 }
 
+void MainWindow::on_streamList_itemExpanded(QTreeWidgetItem* item)
+{
+	StreamGroup* group = dynamic_cast<StreamGroup*>(item);
+	if(!group)
+		return;
+
+	// the group is opened: build its rows and follow the main update timer again
+	group->setActive(true);
+	materializeCollapsed(group);
+
+	for(auto s : group->getStreams()) {
+		s->createWidgets();
+
+		if(!m_readOnly)
+			updateStream(s);
+	}
+}
+
+void MainWindow::on_streamList_itemCollapsed(QTreeWidgetItem* item)
+{
+	StreamGroup* group = dynamic_cast<StreamGroup*>(item);
+	if(!group)
+		return;
+
+	// nothing of a collapsed group is on screen: drop the rows and pending polls
+	if(!m_readOnly)
+		group->setActive(false);
+
+	for(auto s : group->getStreams()) {
+		s->releaseWidgets();
+		s->cancelUpdate();
+		m_updating.remove(s);
+	}
+}
+
+void MainWindow::on_filterEdit_textChanged(const QString& text)
+{
+	if(m_filter.setQuery(text))
+		m_filter.apply();
+}
+
+void MainWindow::on_filterLiveOnly_toggled(bool checked)
+{
+	m_filter.setOnlineOnly(checked);
+	m_filter.apply();
+}
+
 void MainWindow::onStreamStartError(int errorType, const QString& errorTxt)
 {
 	switch(errorType) {
@@ -214,126 +526,678 @@ void MainWindow::onStreamStartError(int errorType, const QString& errorTxt)
 		case StreamItem::ERROR_LS_ERROR:
 			statusError(errorTxt);
 			break;
+		case StreamItem::ERROR_PLAYER_NOT_FOUND:
+			statusError("player not found, recording only");
+			break;
+		case StreamItem::ERROR_RECORDING:
+			statusError(errorTxt);
+			break;
 	}
 }
 
-void MainWindow::onUpdateTimer()
+void MainWindow::onStartup()
 {
-	updateStreams();
+	m_started = true;
+
+	// create the config folder
+	QDir configDir(CONFIG_PATH);
+	if (!configDir.exists()){
+	  configDir.mkpath(".");
+	}
+
+	loadSettings();
+
+	ui->actionRecordStreams->setChecked(m_settings.recordStreams != 0);
+	ui->actionMinimizeToTray->setChecked(m_settings.minimizeToTray != 0);
+	ui->actionMinimizeToTray->setEnabled(QSystemTrayIcon::isSystemTrayAvailable());
+
+	// read-only: no list of our own, no polling, nothing saved on exit
+	if(m_readOnly) {
+		m_instance->subscribe();
+		onMaterializeBatch();
+		return;
+	}
+
+	startPrimary();
 }
 
-void MainWindow::addStream()
+void MainWindow::startPrimary()
 {
-	bool ok;
-	QString text = QInputDialog::getText(this, "Stream url", "Enter the stream url:", QLineEdit::Normal, "", &ok);
+	startStatusServer();
+
+	// auto update
+	ui->actionAutoUpdateStreams->setChecked(false);
+	if(m_settings.autoUpdateStreams) {
+		ui->actionAutoUpdateStreams->setChecked(true);
+		m_updateTimer.start(m_settings.updateInterval * 1000);
+	}
+
+	loadStreams();
+	m_loaded = true;
+
+	m_pollCycle.start();
+
+	onMaterializeBatch();
+}
+
+void MainWindow::onMaterializeBatch()
+{
+	int end = std::min(m_pendingIndex + STARTUP_BATCH_SIZE, m_pendingStreams.size());
+
+	for(; m_pendingIndex < end; m_pendingIndex++) {
+		auto const& entry = m_pendingStreams[m_pendingIndex];
 
-	if (ok && !text.isEmpty()) {
 		try {
-			StreamItem* newStream = createStreamItem(ui->streamList, text, "best");
+			StreamItem* stream = createStreamItem(entry.group, entry.url, entry.quality);
+			registerStream(stream);
 
-			// check for duplicates
-			bool duplicate = false;
-			for(auto s : m_streams) {
-				if(*s == *newStream) {
-					duplicate = true;
-					delete newStream;
-					statusError("Error: duplicate.");
-				}
-			}
+			if(entry.known)
+				stream->setStatus(entry.online, entry.viewers);
 
-			if(!duplicate) {
-				m_streams.append(newStream);
-				newStream->update(); // update new stream
+			if(entry.group->isExpanded()) {
+				stream->createWidgets();
+				if(!entry.known)
+					updateStream(stream); // get viewers and stuff
 			}
 		}
 		catch(StreamException &e) {
 			switch(e.getType()) {
 			case StreamException::INVALID_URL:
-				statusError("Invalid url.");
+				statusError("Loading: Invalid url.");
 				break;
 			case StreamException::HOST_NOT_SUPPORTED:
-				statusError("Host not supported.");
+				statusError("Loading: Host not supported.");
 				break;
 			}
 		}
 	}
+
+	if(m_pendingIndex < m_pendingStreams.size()) {
+		statusStream(QString("Loading streams... %1/%2").arg(m_pendingIndex).arg(m_pendingStreams.size()));
+		QTimer::singleShot(0, this, SLOT(onMaterializeBatch()));
+		return;
+	}
+
+	m_pendingStreams.clear();
+	m_pendingIndex = 0;
+
+	// enable sorting by column, sorts once instead of on every insert
+	ui->streamList->setSortingEnabled(true);
+
+	statusValidate("Streams loaded.");
+
+	if(!m_queuedUrls.isEmpty()) {
+		QStringList urls = m_queuedUrls;
+		m_queuedUrls.clear();
+		addStreamUrls(urls);
+	}
+
+	if(!m_importedUrls.isEmpty()) {
+		QStringList urls = m_importedUrls;
+		m_importedUrls.clear();
+		importFollows(urls);
+	}
+
+	scheduleSnapshot();
+
+	if(m_updating.isEmpty())
+		emit streamsUpdated();
 }
 
-void MainWindow::removeStream()
+void MainWindow::onStreamUpdated()
 {
-	StreamItem* stream = getSelectedStream();
+	StreamItem* stream = static_cast<StreamItem*>(sender());
 
-	if(stream) {
-		int i = 0;
-		for(auto s : m_streams) { // not efficient
-			if(*s == *stream) {
-				m_streams.remove(i);
-				delete s;
-				return;
-			}
-
-			i++;
+	if(m_updating.remove(stream) && m_updating.isEmpty() && m_pendingStreams.isEmpty()) {
+		if(m_pollCycle.isValid()) {
+			m_update->setToolTip(QString("Update all streams (last update: %1 streams in %2 ms)")
+								 .arg(m_pollCycleSize).arg(m_pollCycle.elapsed()));
+			m_pollCycle.invalidate();
 		}
+
+		emit streamsUpdated();
 	}
 }
 
-void MainWindow::watchStream()
+void MainWindow::onStreamStatusChanged()
 {
-	StreamItem* stream = getSelectedStream();
+	m_filter.update(static_cast<StreamItem*>(sender()));
+	scheduleSnapshot();
 
-	if(!stream || !stream->isOnline())
+	if(m_inTray)
+		updateTrayToolTip();
+}
+
+void MainWindow::onStreamWentLive()
+{
+	// the window is in the tray but the list was kept (watching, loading or read-only)
+	if(!m_inTray)
 		return;
 
-	statusStream(stream->getName() + " starting...");
-	stream->watch(m_settings.livestreamerPath);
+	StreamItem* stream = static_cast<StreamItem*>(sender());
+	onTrayStreamLive(stream->getName(), stream->getViewerCount());
+}
 
-	// error signal
-	QObject::connect(stream, SIGNAL(error(int,QString const&)), this, SLOT(onStreamStartError(int,QString const&)));
+void MainWindow::onUpdateTimer()
+{
+	updateStreams();
 }
 
-void MainWindow::updateStreams()
+void MainWindow::onGroupPoll()
 {
-	for(auto s : m_streams) {
-		s->update();
+	if(m_readOnly)
+		return;
+
+	StreamGroup* group = static_cast<StreamGroup*>(sender());
+
+	for(auto s : group->getStreams()) {
+		updateStream(s);
 	}
+
+	group->pollCollapsed();
 }
 
-StreamItem* MainWindow::getSelectedStream()
+void MainWindow::onGroupStatusChanged()
 {
-	auto selectedItems = ui->streamList->selectedItems();
+	scheduleSnapshot();
 
-	if(selectedItems.size() > 0) {
-		return static_cast<StreamItem*>(selectedItems.first());
-	}
+	if(m_inTray)
+		updateTrayToolTip();
+}
 
-	return nullptr;
+void MainWindow::onGroupStreamWentLive(const QString& name, int viewers)
+{
+	// same as onStreamWentLive(), for streams of a group never expanded
+	if(m_inTray)
+		onTrayStreamLive(name, viewers);
 }
 
-void MainWindow::loadStreams()
+void MainWindow::onFollowsProgress(int received, int total)
 {
-	QFile file(CONFIG_PATH + "/" + STREAM_SAVE_FILENAME);
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-		statusError("Failed to load streams.");
+	statusStream(QString("Importing follows... %1/%2").arg(received).arg(total));
+}
+
+void MainWindow::onFollowsImported(const QStringList& urls)
+{
+	m_importer->deleteLater();
+	m_importer = nullptr;
+
+	// still loading, or in the tray: imported as a batch once the view exists
+	if(!m_loaded || !m_pendingStreams.isEmpty() || m_viewReleased) {
+		m_importedUrls = urls;
 		return;
 	}
 
-	while (!file.atEnd()) {
-		QString line = file.readLine();
-		line.remove('\n');
-		QStringList split = line.split(" ", QString::SkipEmptyParts);
+	importFollows(urls);
+}
 
-		QString url = split.first();
-		QString quality = "best";
-		if(split.size() > 1) {
-			quality = split.last();
-		}
+void MainWindow::importFollows(const QStringList& urls)
+{
+	int duplicates;
+	int added = importStreamUrls(urls, m_importGroup, &duplicates);
 
-		try {
-			m_streams.append(createStreamItem(ui->streamList, url, quality));
-		}
-		catch(StreamException &e) {
-			switch(e.getType()) {
-			case StreamException::INVALID_URL:
+	statusValidate(QString("Imported %1 channels, %2 already in the list.").arg(added).arg(duplicates));
+}
+
+void MainWindow::onFollowsFailed(const QString& errorTxt)
+{
+	m_importer->deleteLater();
+	m_importer = nullptr;
+
+	statusError("Import: " + errorTxt);
+}
+
+void MainWindow::onInstanceSubscribed()
+{
+	publishSnapshot();
+}
+
+void MainWindow::onSnapshotReceived(const QByteArray& snapshot)
+{
+	QJsonArray streams = QJsonDocument::fromJson(snapshot).object().value("streams").toArray();
+
+	QHash<QString, StreamItem*> previous;
+	for(auto s : m_streams) {
+		previous.insert(s->getUrl(), s);
+	}
+
+	for(auto value : streams) {
+		QJsonObject entry = value.toObject();
+		QString url = entry.value("url").toString();
+		StreamGroup* group = getGroup(entry.value("group").toString(), true);
+
+		StreamItem* stream = previous.take(url);
+		if(!stream) {
+			try {
+				stream = createStreamItem(group, url, entry.value("quality").toString());
+				registerStream(stream);
+
+				if(group->isExpanded())
+					stream->createWidgets();
+			}
+			catch(StreamException&) {
+				continue;
+			}
+		}
+		else {
+			moveStream(stream, group);
+		}
+
+		stream->setStatus(entry.value("online").toBool(), entry.value("viewers").toInt());
+	}
+
+	// removed on the primary
+	for(auto s : previous) {
+		unregisterStream(s);
+		delete s;
+	}
+}
+
+void MainWindow::onPrimaryLost()
+{
+	// another client was faster, follow it instead
+	if(!m_instance->takeOver()) {
+		m_instance->subscribe();
+		statusValidate("Main instance closed, following the new one.");
+		return;
+	}
+
+	setReadOnly(false);
+	statusValidate("Main instance closed, this one takes over.");
+
+	// onStartup() will load the list
+	if(!m_started)
+		return;
+
+	// the rows built from snapshots make way for the saved list, polled by us now
+	on_actionClearAll_triggered();
+	startPrimary();
+}
+
+void MainWindow::publishSnapshot()
+{
+	m_snapshotTimer.stop();
+
+	if(!wantsSnapshot())
+		return;
+
+	// serialized once, shared by every subscriber and http client
+	m_snapshotVersion++;
+	QByteArray snapshot = buildSnapshot();
+
+	if(m_instance && m_instance->isPrimary() && m_instance->hasSubscribers())
+		m_instance->publish(snapshot);
+
+	if(m_statusServer.isListening())
+		m_statusServer.publish(snapshot, m_snapshotVersion);
+}
+
+void MainWindow::enterTray()
+{
+	// restored before we got here
+	if(m_inTray || !isMinimized())
+		return;
+
+	if(!m_tray) {
+		m_tray = new QSystemTrayIcon(QIcon(":app.ico"), this);
+		connect(m_tray, &QSystemTrayIcon::activated, this, &MainWindow::onTrayActivated);
+
+		QMenu* menu = new QMenu(this);
+		menu->addAction("Show", this, SLOT(restoreFromTray()));
+		menu->addAction("Quit", qApp, SLOT(quit()));
+		m_tray->setContextMenu(menu);
+	}
+
+	m_inTray = true;
+	hide();
+	m_tray->show();
+
+	// rows still loading or being watched are kept, the window is only hidden then
+	bool keepView = !m_loaded || m_readOnly || !m_pendingStreams.isEmpty();
+	for(auto s : m_streams) {
+		if(s->isWatching())
+			keepView = true;
+	}
+
+	if(!keepView)
+		releaseView();
+
+	updateTrayToolTip();
+}
+
+void MainWindow::restoreFromTray()
+{
+	if(!m_inTray)
+		return;
+
+	m_inTray = false;
+	m_tray->hide();
+
+	if(m_viewReleased)
+		rebuildView();
+
+	showNormal();
+	raise();
+	activateWindow();
+}
+
+void MainWindow::onTrayActivated(QSystemTrayIcon::ActivationReason reason)
+{
+	if(reason == QSystemTrayIcon::Trigger || reason == QSystemTrayIcon::DoubleClick)
+		restoreFromTray();
+}
+
+void MainWindow::onTrayStreamLive(const QString& name, int viewers)
+{
+	m_tray->showMessage(name + " is live", QString("%1 viewers").arg(viewers));
+}
+
+void MainWindow::onTrayStatusChanged()
+{
+	scheduleSnapshot();
+	updateTrayToolTip();
+}
+
+void MainWindow::measureTrayMemory()
+{
+	if(!m_viewReleased)
+		return;
+
+	releaseFreeMemory();
+	m_trayMemory = residentMemory();
+	updateTrayToolTip();
+}
+
+void MainWindow::releaseView()
+{
+	m_viewMemory = residentMemory();
+
+	// keep what is needed to poll, save and rebuild, in list order
+	QVector<GroupRecord> groups;
+	QVector<StreamRecord> streams;
+	streams.reserve(m_streams.size());
+
+	for(int i = 0; i < m_groups.size(); i++) {
+		StreamGroup* g = m_groups[i];
+		groups.append({ g->getName(), g->getPollInterval(), g->isExpanded(), 0 });
+
+		for(auto s : g->getStreams()) {
+			streams.append({ s->getUrl(), s->getName(), s->getQuality(), i, s->isOnline(), s->getViewerCount() });
+		}
+
+		for(auto const& s : g->getCollapsed()) {
+			streams.append({ s.url, streamName(s.url), s.quality, i, s.online, s.viewers });
+		}
+	}
+
+	m_updateTimer.stop();
+	m_filter.clear();
+	m_updating.clear();
+	ui->streamList->setSortingEnabled(false);
+
+	for(auto s : m_streams) {
+		delete s;
+	}
+	m_streams.clear();
+
+	for(auto g : m_groups) {
+		delete g;
+	}
+	m_groups.clear();
+
+	m_trayPoller.start(groups, streams, m_settings.autoUpdateStreams ? m_settings.updateInterval : 0);
+	m_viewReleased = true;
+
+	QTimer::singleShot(TRAY_MEASURE_DELAY, this, SLOT(measureTrayMemory()));
+}
+
+void MainWindow::rebuildView()
+{
+	m_trayPoller.stop();
+
+	QVector<StreamGroup*> groups;
+	for(auto const& g : m_trayPoller.getGroups()) {
+		StreamGroup* group = getGroup(g.name, true);
+		group->setPollInterval(g.pollInterval);
+		group->setExpanded(g.expanded);
+		if(!g.expanded)
+			group->setActive(false);
+		groups.append(group);
+	}
+
+	// materialized in batches like on startup, with the status the tray last saw,
+	// collapsed groups keep records until they are expanded
+	for(auto const& s : m_trayPoller.getStreams()) {
+		StreamGroup* group = groups[s.group];
+
+		if(group->isExpanded())
+			m_pendingStreams.append({ s.url, s.quality, group, true, s.online, s.viewers });
+		else
+			group->addCollapsed({ s.url, s.quality, true, s.online, s.viewers });
+	}
+
+	for(auto g : groups) {
+		g->updateWidgetItem();
+	}
+
+	m_trayPoller.clear();
+	m_viewReleased = false;
+	m_trayMemory = -1;
+
+	if(m_settings.autoUpdateStreams)
+		m_updateTimer.start(m_settings.updateInterval * 1000);
+
+	onMaterializeBatch();
+}
+
+void MainWindow::updateTrayToolTip()
+{
+	if(!m_tray)
+		return;
+
+	int online = 0;
+	if(m_viewReleased) {
+		online = m_trayPoller.onlineCount();
+	}
+	else {
+		for(auto s : m_streams) {
+			if(s->isOnline())
+				online++;
+		}
+
+		for(auto g : m_groups) {
+			for(auto const& s : g->getCollapsed()) {
+				if(s.online)
+					online++;
+			}
+		}
+	}
+
+	QString tip = windowTitle() + QString("\n%1 live").arg(online);
+
+	if(m_viewMemory > 0 && m_trayMemory > 0) {
+		tip += QString("\nMemory: %1 MB (%2 MB with the list)")
+			   .arg(m_trayMemory / (1024.0 * 1024.0), 0, 'f', 1)
+			   .arg(m_viewMemory / (1024.0 * 1024.0), 0, 'f', 1);
+	}
+
+	m_tray->setToolTip(tip);
+}
+
+void MainWindow::registerStream(StreamItem* stream)
+{
+	m_streams.append(stream);
+	m_filter.insert(stream);
+	connect(stream, &StreamItem::statusChanged, this, &MainWindow::onStreamStatusChanged);
+	connect(stream, &StreamItem::wentLive, this, &MainWindow::onStreamWentLive);
+	connect(stream, &StreamItem::updated, this, &MainWindow::onStreamUpdated);
+	stream->getGroup()->updateWidgetItem();
+	scheduleSnapshot();
+}
+
+void MainWindow::unregisterStream(StreamItem* stream)
+{
+	m_updating.remove(stream);
+	m_filter.remove(stream);
+	m_streams.removeOne(stream);
+
+	// take it out of its group now so the count is right, the view deletes item widgets of removed rows
+	StreamGroup* group = stream->getGroup();
+	stream->releaseWidgets();
+	group->removeChild(stream);
+	group->updateWidgetItem();
+
+	scheduleSnapshot();
+}
+
+void MainWindow::addStream()
+{
+	bool ok;
+	QString text = QInputDialog::getText(this, "Stream url", "Enter the stream url:", QLineEdit::Normal, "", &ok);
+
+	if (ok && !text.isEmpty()) {
+		addStreamUrl(text, getSelectedGroup());
+	}
+}
+
+bool MainWindow::addStreamUrl(const QString& url, StreamGroup* group)
+{
+	if(!group)
+		group = getDefaultGroup();
+
+	try {
+		StreamItem* newStream = createStreamItem(group, url, "best");
+
+		// check for duplicates, records of collapsed groups included
+		bool duplicate = false;
+		for(auto s : m_streams) {
+			if(*s == *newStream)
+				duplicate = true;
+		}
+
+		for(auto g : m_groups) {
+			for(auto const& s : g->getCollapsed()) {
+				if(s.url == newStream->getUrl())
+					duplicate = true;
+			}
+		}
+
+		if(duplicate) {
+			delete newStream;
+			statusError("Error: duplicate.");
+			return false;
+		}
+
+		registerStream(newStream);
+		if(group->isExpanded())
+			newStream->createWidgets();
+		updateStream(newStream); // update new stream
+		return true;
+	}
+	catch(StreamException &e) {
+		switch(e.getType()) {
+		case StreamException::INVALID_URL:
+			statusError("Invalid url.");
+			break;
+		case StreamException::HOST_NOT_SUPPORTED:
+			statusError("Host not supported.");
+			break;
+		}
+	}
+
+	return false;
+}
+
+int MainWindow::importStreamUrls(const QStringList& urls, const QString& groupName, int* duplicates)
+{
+	StreamGroup* group = getGroup(groupName, false);
+	if(!group)
+		group = getDefaultGroup();
+
+	// one duplicate check for the whole batch instead of a scan of the list per url
+	QSet<QString> known;
+	known.reserve(m_streams.size() + urls.size());
+	for(auto s : m_streams) {
+		known.insert(s->getUrl());
+	}
+
+	for(auto g : m_groups) {
+		for(auto const& s : g->getCollapsed()) {
+			known.insert(s.url);
+		}
+	}
+
+	*duplicates = 0;
+	QList<QTreeWidgetItem*> items;
+
+	for(auto const& url : urls) {
+		StreamItem* stream;
+		try {
+			stream = createStreamItem(nullptr, url, "best");
+		}
+		catch(StreamException&) {
+			continue;
+		}
+
+		if(known.contains(stream->getUrl())) {
+			delete stream;
+			(*duplicates)++;
+			continue;
+		}
+
+		known.insert(stream->getUrl());
+		items.append(stream);
+	}
+
+	if(items.isEmpty())
+		return 0;
+
+	// inserted in one go, sorted and painted once
+	ui->streamList->setSortingEnabled(false);
+	ui->streamList->setUpdatesEnabled(false);
+
+	group->addChildren(items);
+
+	for(auto item : items) {
+		StreamItem* stream = static_cast<StreamItem*>(item);
+		registerStream(stream);
+
+		if(group->isExpanded())
+			stream->createWidgets();
+	}
+
+	ui->streamList->setUpdatesEnabled(true);
+	ui->streamList->setSortingEnabled(true);
+
+	for(auto item : items) {
+		updateStream(static_cast<StreamItem*>(item));
+	}
+
+	return items.size();
+}
+
+void MainWindow::materializeCollapsed(StreamGroup* group)
+{
+	QVector<CollapsedStream> records = group->takeCollapsed();
+	if(records.isEmpty())
+		return;
+
+	// inserted in one go like an import, with the status the records last saw
+	bool sorting = ui->streamList->isSortingEnabled();
+	ui->streamList->setSortingEnabled(false);
+	ui->streamList->setUpdatesEnabled(false);
+
+	for(auto const& r : records) {
+		try {
+			StreamItem* stream = createStreamItem(group, r.url, r.quality);
+			registerStream(stream);
+
+			if(r.known)
+				stream->setStatus(r.online, r.viewers);
+		}
+		catch(StreamException &e) {
+			switch(e.getType()) {
+			case StreamException::INVALID_URL:
 				statusError("Loading: Invalid url.");
 				break;
 			case StreamException::HOST_NOT_SUPPORTED:
@@ -343,20 +1207,334 @@ void MainWindow::loadStreams()
 		}
 	}
 
-	statusValidate("Streams loaded.");
+	ui->streamList->setUpdatesEnabled(true);
+	ui->streamList->setSortingEnabled(sorting);
+	group->updateWidgetItem();
 }
 
-void MainWindow::saveStreams()
+void MainWindow::removeStream()
+{
+	StreamItem* stream = getSelectedStream();
+
+	// a group is selected
+	if(!stream && getSelectedGroup()) {
+		removeGroup(getSelectedGroup());
+		return;
+	}
+
+	if(stream) {
+		for(auto s : m_streams) { // not efficient
+			if(*s == *stream) {
+				unregisterStream(s);
+				delete s;
+				return;
+			}
+		}
+	}
+}
+
+void MainWindow::moveStream(StreamItem* stream, StreamGroup* group)
 {
-	QFile file(CONFIG_PATH + "/" + STREAM_SAVE_FILENAME);
-	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	StreamGroup* previous = stream->getGroup();
+	if(!group || previous == group)
 		return;
 
-	QTextStream out(&file);
+	// the view deletes item widgets of removed rows
+	stream->releaseWidgets();
+	previous->removeChild(stream);
+	group->addChild(stream);
+
+	if(group->isExpanded())
+		stream->createWidgets();
+
+	previous->updateWidgetItem();
+	group->updateWidgetItem();
+	scheduleSnapshot();
+}
+
+void MainWindow::watchStream()
+{
+	StreamItem* stream = getSelectedStream();
+
+	if(!stream || !stream->isOnline())
+		return;
+
+	statusStream(stream->getName() + " starting...");
+
+	if(m_settings.recordStreams) {
+		QDir recordDir(CONFIG_PATH + "/" + RECORD_DIR_NAME);
+		if(!recordDir.exists()) {
+			recordDir.mkpath(".");
+		}
+
+		QString recordPath = recordDir.filePath(stream->getName() + "_" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss") + ".ts");
+		stream->watchAndRecord(m_settings.livestreamerPath, m_settings.playerPath, recordPath);
+	}
+	else {
+		stream->watch(m_settings.livestreamerPath);
+	}
+
+	// error signal
+	QObject::connect(stream, SIGNAL(error(int,QString const&)), this, SLOT(onStreamStartError(int,QString const&)));
+}
+
+void MainWindow::updateStream(StreamItem* stream)
+{
+	if(stream->update())
+		m_updating.insert(stream);
+}
+
+void MainWindow::updateStreams()
+{
+	// one poll cycle over the open groups, timed until the last stream answered
+	m_pollCycle.start();
+	m_pollCycleSize = 0;
+
+	for(auto g : m_groups) {
+		if(!g->isExpanded())
+			continue;
+
+		for(auto s : g->getStreams()) {
+			updateStream(s);
+			m_pollCycleSize++;
+		}
+	}
+}
+
+StreamItem* MainWindow::getSelectedStream()
+{
+	auto selectedItems = ui->streamList->selectedItems();
+
+	if(selectedItems.size() > 0) {
+		return dynamic_cast<StreamItem*>(selectedItems.first());
+	}
+
+	return nullptr;
+}
+
+StreamGroup* MainWindow::getSelectedGroup()
+{
+	auto selectedItems = ui->streamList->selectedItems();
+
+	if(selectedItems.size() > 0) {
+		QTreeWidgetItem* item = selectedItems.first();
+		if(item->parent())
+			item = item->parent();
+		return dynamic_cast<StreamGroup*>(item);
+	}
+
+	return nullptr;
+}
+
+StreamGroup* MainWindow::getGroup(const QString& name, bool create)
+{
+	QString groupName = name.isEmpty() ? DEFAULT_GROUP_NAME : name;
+
+	for(auto g : m_groups) {
+		if(g->getName() == groupName)
+			return g;
+	}
+
+	if(!create)
+		return nullptr;
+
+	StreamGroup* group = new StreamGroup(ui->streamList, groupName, DEFAULT_GROUP_POLL_INTERVAL);
+	connect(group, &StreamGroup::pollRequested, this, &MainWindow::onGroupPoll);
+	connect(group, &StreamGroup::collapsedStatusChanged, this, &MainWindow::onGroupStatusChanged);
+	connect(group, &StreamGroup::collapsedWentLive, this, &MainWindow::onGroupStreamWentLive);
+	m_groups.append(group);
+	return group;
+}
+
+StreamGroup* MainWindow::getDefaultGroup()
+{
+	if(m_groups.isEmpty()) {
+		getGroup(DEFAULT_GROUP_NAME, true)->setExpanded(true);
+	}
+
+	return m_groups.first();
+}
+
+void MainWindow::removeGroup(StreamGroup* group)
+{
+	if(group == getDefaultGroup()) {
+		statusError("The default group can't be removed.");
+		return;
+	}
+
+	if(group->streamCount() > 0) {
+		statusError("Group not empty.");
+		return;
+	}
+
+	m_groups.removeOne(group);
+	delete group;
+	scheduleSnapshot();
+}
+
+void MainWindow::loadStreams()
+{
+	QVector<StreamListGroup> groups;
+	if(!readStreamList(CONFIG_PATH + "/" + STREAM_SAVE_FILENAME, &groups)) {
+		getDefaultGroup();
+		statusError("Failed to load streams.");
+		return;
+	}
+
+	// streams before the first group header go to the default group
+	getDefaultGroup();
+
+	// only read the list here, the items are created in batches by onMaterializeBatch()
+	for(auto const& g : groups) {
+		StreamGroup* group = getDefaultGroup();
+
+		if(!g.name.isEmpty()) {
+			group = getGroup(g.name, true);
+
+			if(g.pollInterval >= 10)
+				group->setPollInterval(g.pollInterval);
+
+			group->setExpanded(!g.collapsed);
+			if(g.collapsed)
+				group->setActive(false);
+		}
+
+		// a collapsed group's streams stay records until it is expanded
+		for(auto const& s : g.streams) {
+			if(group->isExpanded())
+				m_pendingStreams.append({ s.url, s.quality, group });
+			else
+				group->addCollapsed({ s.url, s.quality, false, false, 0 });
+		}
+	}
+
+	for(auto g : m_groups) {
+		g->updateWidgetItem();
+	}
+}
+
+void MainWindow::saveStreams()
+{
+	QVector<StreamListGroup> groups;
+
+	// in the tray the list only exists as records
+	if(m_viewReleased) {
+		for(auto const& g : m_trayPoller.getGroups()) {
+			groups.append({ g.name, g.pollInterval, !g.expanded, {} });
+		}
+
+		for(auto const& s : m_trayPoller.getStreams()) {
+			groups[s.group].streams.append({ s.url, s.quality });
+		}
+	}
+	else {
+		for(auto g : m_groups) {
+			StreamListGroup group = { g->getName(), g->getPollInterval(), !g->isExpanded(), {} };
+
+			// live streams first so they are materialized and polled first on next startup
+			QVector<StreamItem*> streams = g->getStreams();
+			std::stable_sort(streams.begin(), streams.end(), [](StreamItem* a, StreamItem* b) {
+				if(a->isOnline() != b->isOnline())
+					return a->isOnline();
+				return a->getViewerCount() > b->getViewerCount();
+			});
+
+			for(auto s : streams) {
+				group.streams.append({ s->getUrl(), s->getQuality() });
+			}
+
+			for(auto const& s : g->getCollapsed()) {
+				group.streams.append({ s.url, s.quality });
+			}
+
+			// not materialized yet
+			for(int i = m_pendingIndex; i < m_pendingStreams.size(); i++) {
+				if(m_pendingStreams[i].group == g)
+					group.streams.append({ m_pendingStreams[i].url, m_pendingStreams[i].quality });
+			}
+
+			groups.append(group);
+		}
+	}
+
+	writeStreamList(CONFIG_PATH + "/" + STREAM_SAVE_FILENAME, groups);
+}
+
+QByteArray MainWindow::buildSnapshot() const
+{
+	QJsonArray streams;
+
+	if(m_viewReleased) {
+		auto const& groups = m_trayPoller.getGroups();
+
+		for(auto const& s : m_trayPoller.getStreams()) {
+			QJsonObject entry;
+			entry.insert("name", s.name);
+			entry.insert("group", groups[s.group].name);
+			entry.insert("url", s.url);
+			entry.insert("quality", s.quality);
+			entry.insert("online", s.online);
+			entry.insert("viewers", s.viewers);
+			streams.append(entry);
+		}
+	}
 
 	for(auto s : m_streams) {
-		out << s->getUrl() << " " << s->getQuality() << "\n";
+		QJsonObject entry;
+		entry.insert("name", s->getName());
+		entry.insert("group", s->getGroup()->getName());
+		entry.insert("url", s->getUrl());
+		entry.insert("quality", s->getQuality());
+		entry.insert("online", s->isOnline());
+		entry.insert("viewers", s->getViewerCount());
+		streams.append(entry);
+	}
+
+	for(auto g : m_groups) {
+		for(auto const& s : g->getCollapsed()) {
+			QJsonObject entry;
+			entry.insert("name", streamName(s.url));
+			entry.insert("group", g->getName());
+			entry.insert("url", s.url);
+			entry.insert("quality", s.quality);
+			entry.insert("online", s.online);
+			entry.insert("viewers", s.viewers);
+			streams.append(entry);
+		}
 	}
+
+	QJsonObject root;
+	root.insert("version", m_snapshotVersion);
+	root.insert("streams", streams);
+
+	return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool MainWindow::wantsSnapshot() const
+{
+	return (m_instance && m_instance->hasSubscribers()) || m_statusServer.isListening();
+}
+
+void MainWindow::scheduleSnapshot()
+{
+	// coalesce bursts of status changes (a poll cycle) into one snapshot
+	if(!m_snapshotTimer.isActive() && wantsSnapshot())
+		m_snapshotTimer.start();
+}
+
+void MainWindow::startStatusServer()
+{
+	m_statusServer.stop();
+
+	if(m_settings.statusServerPort == 0)
+		return;
+
+	if(!m_statusServer.start(m_settings.statusServerPort)) {
+		statusError(QString("Status server: port %1 unavailable.").arg(m_settings.statusServerPort));
+		return;
+	}
+
+	publishSnapshot();
 }
 
 void MainWindow::loadSettings()
@@ -370,6 +1548,10 @@ void MainWindow::loadSettings()
 	QString livestreamerPath;
 	unsigned int autoUpdateStreams;
 	unsigned int updateInterval;
+	QString playerPath;
+	unsigned int recordStreams;
+	unsigned int statusServerPort;
+	unsigned int minimizeToTray;
 
 	QString line = file.readLine();
 	line.remove('\n');
@@ -383,12 +1565,36 @@ void MainWindow::loadSettings()
 	line.remove('\n');
 	updateInterval = line.toInt();
 
+	line = file.readLine();
+	line.remove('\n');
+	playerPath = line;
+
+	line = file.readLine();
+	line.remove('\n');
+	recordStreams = line.toInt();
+
+	line = file.readLine();
+	line.remove('\n');
+	statusServerPort = line.toInt();
+
+	line = file.readLine();
+	line.remove('\n');
+	minimizeToTray = line.toInt();
+
 	if(livestreamerPath.length() > 1)
 		m_settings.livestreamerPath = livestreamerPath;
 	if(autoUpdateStreams < 2)
 		m_settings.autoUpdateStreams = autoUpdateStreams;
 	if(updateInterval > 2 && updateInterval < 60*60*5) // 5h hours max
 		m_settings.updateInterval = updateInterval;
+	if(playerPath.length() > 1)
+		m_settings.playerPath = playerPath;
+	if(recordStreams < 2)
+		m_settings.recordStreams = recordStreams;
+	if(statusServerPort < 65536)
+		m_settings.statusServerPort = statusServerPort;
+	if(minimizeToTray < 2)
+		m_settings.minimizeToTray = minimizeToTray;
 
 	statusValidate("Settings loaded.");
 }
@@ -404,4 +1610,8 @@ void MainWindow::saveSettings()
 	out << m_settings.livestreamerPath << "\n";
 	out << m_settings.autoUpdateStreams << "\n";
 	out << m_settings.updateInterval << "\n";
+	out << m_settings.playerPath << "\n";
+	out << m_settings.recordStreams << "\n";
+	out << m_settings.statusServerPort << "\n";
+	out << m_settings.minimizeToTray << "\n";
 }
@@ -6,9 +6,19 @@
 #include <QPushButton>
 #include <QString>
 #include <QTimer>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QSystemTrayIcon>
 #include "stream.h"
+#include "streamgroup.h"
+#include "streamfilter.h"
+#include "statusserver.h"
+#include "traypoller.h"
 #include "configpath.h"
 
+class SingleInstance;
+class FollowImporter;
+
 namespace Ui {
 class MainWindow;
 }
@@ -25,15 +35,54 @@ public:
 	void statusValidate(QString const& msg);
 	void statusError(QString const& msg);
 
+	/**
+	 * @brief Share polling with other instances, must be called before show()
+	 *
+	 * A secondary instance becomes a read-only view of the primary's snapshots.
+	 */
+	void setInstance(SingleInstance* instance);
+
+	/**
+	 * @brief Add streams by url, queued until the saved list is loaded
+	 */
+	void addStreamUrls(QStringList const& urls);
+
+	/**
+	 * @brief Add a batch of urls to a group (the default one if it doesn't exist), inserted and sorted once
+	 * @return the number added, duplicates are skipped and counted
+	 */
+	int importStreamUrls(QStringList const& urls, QString const& groupName, int* duplicates);
+
+signals:
+	void firstPaint();
+	void streamsUpdated(); // every stream loaded and every pending update answered
+
+protected:
+	bool eventFilter(QObject* watched, QEvent* event);
+	void changeEvent(QEvent* event);
+
 private slots:
+	// Startup
+	void onStartup();
+	void onMaterializeBatch();
+
 	// Stream menu
 	void on_actionAddStream_triggered();
 	void on_actionRemoveSelected_triggered();
 	void on_actionClearAll_triggered();
+	void on_actionAddGroup_triggered();
+	void on_actionMoveToGroup_triggered();
+	void on_actionGroupPollInterval_triggered();
+	void on_actionViewLog_triggered();
+	void on_actionImportFollows_triggered();
 
 	// Options menu
 	void on_actionSetLivestreamerLocation_triggered();
+	void on_actionSetPlayerLocation_triggered();
 	void on_actionAutoUpdateStreams_triggered();
+	void on_actionRecordStreams_triggered();
+	void on_actionStatusServer_triggered();
+	void on_actionMinimizeToTray_triggered();
 
 	// About menu
 	void on_actionAboutLivestreamerUI_triggered();
@@ -47,14 +96,46 @@ private slots:
 
 	// Item list
 	void on_streamList_itemDoubleClicked(QTreeWidgetItem *item, int column);
+	void on_streamList_itemExpanded(QTreeWidgetItem *item);
+	void on_streamList_itemCollapsed(QTreeWidgetItem *item);
+
+	// Filter bar
+	void on_filterEdit_textChanged(QString const& text);
+	void on_filterLiveOnly_toggled(bool checked);
 
 	//
 	void onStreamStartError(int errorType, QString const& errorTxt);
+	void onStreamStatusChanged();
+	void onStreamWentLive();
+	void onStreamUpdated();
 	void onUpdateTimer();
+	void onGroupPoll();
+	void onGroupStatusChanged();
+	void onGroupStreamWentLive(QString const& name, int viewers);
+
+	// Follows import
+	void onFollowsProgress(int received, int total);
+	void onFollowsImported(QStringList const& urls);
+	void onFollowsFailed(QString const& errorTxt);
+
+	// Instance sharing
+	void onInstanceSubscribed();
+	void onSnapshotReceived(QByteArray const& snapshot);
+	void onPrimaryLost();
+	void publishSnapshot();
+
+	// Tray
+	void enterTray();
+	void restoreFromTray();
+	void onTrayActivated(QSystemTrayIcon::ActivationReason reason);
+	void onTrayStreamLive(QString const& name, int viewers);
+	void onTrayStatusChanged();
+	void measureTrayMemory();
 
 private:
 	Ui::MainWindow *ui;
 	QVector<StreamItem*> m_streams;
+	QVector<StreamGroup*> m_groups; // the first one is the default group
 
 	QPushButton* m_add;
 	QPushButton* m_remove;
@@ -65,22 +146,86 @@ private:
 		QString livestreamerPath;
 		unsigned int autoUpdateStreams;
 		unsigned int updateInterval;
+		QString playerPath;
+		unsigned int recordStreams;
+		unsigned int statusServerPort; // 0: disabled
+		unsigned int minimizeToTray;
 	} m_settings;
 
 	QTimer m_updateTimer;
+	StreamFilter m_filter;
+
+	bool m_started; // onStartup() ran
+	bool m_loaded;
+	struct PendingStream {
+		QString url;
+		QString quality;
+		StreamGroup* group;
+		bool known; // status kept from the tray, no need to poll
+		bool online;
+		int viewers;
+	};
+
+	QVector<PendingStream> m_pendingStreams; // not materialized yet
+	int m_pendingIndex;
+	QSet<StreamItem*> m_updating;
+	QElapsedTimer m_pollCycle;
+	int m_pollCycleSize;
+	QStringList m_queuedUrls;
+
+	SingleInstance* m_instance;
+	bool m_readOnly;
+	QTimer m_snapshotTimer;
+	qint64 m_snapshotVersion;
+	StatusServer m_statusServer;
+
+	QSystemTrayIcon* m_tray; // created the first time the window goes to the tray
+	TrayPoller m_trayPoller;
+	bool m_inTray;
+	bool m_viewReleased; // streams and groups only exist as the poller's records
+	qint64 m_viewMemory; // resident memory before and after releasing the view
+	qint64 m_trayMemory;
+
+	FollowImporter* m_importer; // while an import runs
+	QString m_importGroup;
+	QStringList m_importedUrls; // finished while loading or in the tray, imported once the view exists
+
+	void registerStream(StreamItem* stream);
+	void unregisterStream(StreamItem* stream);
 
 	void addStream();
+	bool addStreamUrl(QString const& url, StreamGroup* group = nullptr);
+	void materializeCollapsed(StreamGroup* group);
+	void importFollows(QStringList const& urls);
 	void removeStream();
+	void moveStream(StreamItem* stream, StreamGroup* group);
 	void watchStream();
+	void updateStream(StreamItem* stream);
 	void updateStreams();
 
 	StreamItem* getSelectedStream();
+	StreamGroup* getSelectedGroup(); // selected group, or group of the selected stream
+
+	StreamGroup* getGroup(QString const& name, bool create);
+	StreamGroup* getDefaultGroup();
+	void removeGroup(StreamGroup* group);
 
 	void loadStreams();
 	void saveStreams();
 
 	void loadSettings();
 	void saveSettings();
+
+	QByteArray buildSnapshot() const;
+	bool wantsSnapshot() const;
+	void scheduleSnapshot();
+	void startStatusServer();
+	void startPrimary(); // load the list and poll it
+	void setReadOnly(bool readOnly);
+
+	void releaseView();
+	void rebuildView();
+	void updateTrayToolTip();
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,188 @@
+#include "singleinstance.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QLockFile>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QtDebug>
+
+#define INSTANCE_SERVER_NAME "livestreamer-ui-"
+#define INSTANCE_CONNECT_TIMEOUT 500 // ms
+#define INSTANCE_STARTUP_TIMEOUT 5000 // ms, how long another instance may take to start listening
+
+SingleInstance::SingleInstance(QObject* parent)
+	: QObject(parent)
+{
+	m_server = nullptr;
+	m_primary = nullptr;
+	m_lock = new QLockFile(QDir::tempPath() + "/" + serverName() + ".lock");
+	m_lock->setStaleLockTime(0); // a long-running primary is not stale, only a dead one
+}
+
+SingleInstance::~SingleInstance()
+{
+	if(m_server)
+		m_server->close();
+
+	delete m_lock; // unlocks
+}
+
+QString SingleInstance::serverName()
+{
+	// one primary per user
+	QString user = qgetenv("USER");
+	if(user.isEmpty())
+		user = qgetenv("USERNAME");
+	return INSTANCE_SERVER_NAME + user;
+}
+
+bool SingleInstance::start()
+{
+	if(connectToPrimary(INSTANCE_CONNECT_TIMEOUT))
+		return false;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	// the lock holder is the primary, or about to be: wait for it to listen
+	while(!m_lock->tryLock(INSTANCE_CONNECT_TIMEOUT)) {
+		if(connectToPrimary(INSTANCE_CONNECT_TIMEOUT))
+			return false;
+
+		if(timer.elapsed() > INSTANCE_STARTUP_TIMEOUT) {
+			qWarning() << "SingleInstance: the running instance doesn't answer, starting without it";
+			m_server = new QLocalServer(this);
+			connect(m_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+			return true;
+		}
+	}
+
+	listen();
+	return true;
+}
+
+bool SingleInstance::takeOver()
+{
+	if(m_primary) {
+		m_primary->disconnect(this);
+		m_primary->deleteLater();
+		m_primary = nullptr;
+	}
+
+	return start();
+}
+
+bool SingleInstance::connectToPrimary(int timeout)
+{
+	QLocalSocket* socket = new QLocalSocket(this);
+	socket->connectToServer(serverName());
+
+	if(!socket->waitForConnected(timeout)) {
+		delete socket;
+		return false;
+	}
+
+	m_primary = socket;
+	connect(m_primary, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+	connect(m_primary, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+	return true;
+}
+
+void SingleInstance::listen()
+{
+	m_server = new QLocalServer(this);
+	connect(m_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+
+	if(!m_server->listen(serverName())) {
+		// we hold the lock and nobody answered, so this is a stale socket left by a crash
+		QLocalServer::removeServer(serverName());
+		if(!m_server->listen(serverName()))
+			qWarning() << "SingleInstance: failed to listen:" << m_server->errorString();
+	}
+}
+
+bool SingleInstance::isPrimary() const
+{
+	return m_primary == nullptr;
+}
+
+bool SingleInstance::sendUrls(const QStringList& urls)
+{
+	if(!m_primary)
+		return false;
+
+	for(auto url : urls) {
+		m_primary->write("ADD " + url.toUtf8() + "\n");
+	}
+
+	return m_primary->waitForBytesWritten(INSTANCE_CONNECT_TIMEOUT);
+}
+
+void SingleInstance::subscribe()
+{
+	if(m_primary)
+		m_primary->write("SUBSCRIBE\n");
+}
+
+bool SingleInstance::hasSubscribers() const
+{
+	return !m_subscribers.isEmpty();
+}
+
+void SingleInstance::publish(const QByteArray& snapshot)
+{
+	QByteArray message = "SNAPSHOT " + snapshot + "\n";
+
+	for(auto socket : m_subscribers) {
+		socket->write(message);
+	}
+}
+
+void SingleInstance::onNewConnection()
+{
+	while(m_server->hasPendingConnections()) {
+		QLocalSocket* socket = m_server->nextPendingConnection();
+		connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+		connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+	}
+}
+
+void SingleInstance::onReadyRead()
+{
+	QLocalSocket* socket = static_cast<QLocalSocket*>(sender());
+
+	while(socket->canReadLine()) {
+		QByteArray line = socket->readLine();
+		line.chop(1); // '\n'
+		handleMessage(socket, line);
+	}
+}
+
+void SingleInstance::onDisconnected()
+{
+	QLocalSocket* socket = static_cast<QLocalSocket*>(sender());
+
+	if(socket == m_primary) {
+		emit primaryLost();
+		return;
+	}
+
+	m_subscribers.removeOne(socket);
+	socket->deleteLater();
+}
+
+void SingleInstance::handleMessage(QLocalSocket* socket, const QByteArray& message)
+{
+	if(isPrimary()) {
+		if(message.startsWith("ADD ")) {
+			emit urlsReceived(QStringList() << QString::fromUtf8(message.mid(4)));
+		}
+		else if(message == "SUBSCRIBE") {
+			m_subscribers.append(socket);
+			emit subscribed();
+		}
+	}
+	else if(message.startsWith("SNAPSHOT ")) {
+		emit snapshotReceived(message.mid(9));
+	}
+}
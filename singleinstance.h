@@ -0,0 +1,76 @@
+#ifndef SINGLEINSTANCE_H
+#define SINGLEINSTANCE_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+class QLockFile;
+
+/**
+ * @brief Single-instance detection and status sharing over a local socket
+ *
+ * The first instance listens and keeps polling. Later launches either forward
+ * their urls to it and exit, or subscribe and receive its status snapshots
+ * instead of polling themselves.
+ *
+ * Messages are single lines: "ADD <url>", "SUBSCRIBE" and "SNAPSHOT <json>".
+ *
+ * The primary holds a lock file for its lifetime, so two instances launched
+ * at the same moment can't both take over the socket.
+ */
+class SingleInstance : public QObject
+{
+	Q_OBJECT
+
+	QLocalServer* m_server;
+	QLockFile* m_lock; // held by the primary
+	QLocalSocket* m_primary; // our connection when we are not the primary
+	QList<QLocalSocket*> m_subscribers;
+
+	static QString serverName();
+	bool connectToPrimary(int timeout);
+	void listen();
+	void handleMessage(QLocalSocket* socket, QByteArray const& message);
+
+private slots:
+	void onNewConnection();
+	void onReadyRead();
+	void onDisconnected();
+
+signals:
+	void urlsReceived(QStringList const& urls); // primary only
+	void subscribed(); // primary only, a client wants the current snapshot
+	void snapshotReceived(QByteArray const& snapshot); // client only
+	void primaryLost(); // client only
+
+public:
+	explicit SingleInstance(QObject* parent = nullptr);
+	~SingleInstance();
+
+	/**
+	 * @brief Connect to a running instance, or become the primary one
+	 * @return true if we are the primary instance
+	 */
+	bool start();
+	bool isPrimary() const;
+
+	/**
+	 * @brief After primaryLost(): become the primary, or connect to the client that did
+	 * @return true if we are the primary instance now
+	 */
+	bool takeOver();
+
+	// client side
+	bool sendUrls(QStringList const& urls);
+	void subscribe();
+
+	// primary side
+	bool hasSubscribers() const;
+	void publish(QByteArray const& snapshot);
+};
+
+#endif // SINGLEINSTANCE_H
@@ -0,0 +1,41 @@
+# Sources shared by the application and the benchmarks
+
+QT       += core gui network
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/stream.cpp \
+    $$PWD/twitchstream.cpp \
+    $$PWD/configpath.cpp \
+    $$PWD/streamfilter.cpp \
+    $$PWD/streamtee.cpp \
+    $$PWD/singleinstance.cpp \
+    $$PWD/statusserver.cpp \
+    $$PWD/taskscope.cpp \
+    $$PWD/streamgroup.cpp \
+    $$PWD/logviewer.cpp \
+    $$PWD/traypoller.cpp \
+    $$PWD/followimporter.cpp \
+    $$PWD/streamlist.cpp
+SOURCES += $$PWD/mainwindow.cpp
+
+HEADERS += $$PWD/mainwindow.h \
+    $$PWD/stream.h \
+    $$PWD/twitchstream.h \
+    $$PWD/configpath.h \
+    $$PWD/streamfilter.h \
+    $$PWD/streamtee.h \
+    $$PWD/singleinstance.h \
+    $$PWD/statusserver.h \
+    $$PWD/taskscope.h \
+    $$PWD/streamgroup.h \
+    $$PWD/logviewer.h \
+    $$PWD/traypoller.h \
+    $$PWD/followimporter.h \
+    $$PWD/streamlist.h
+
+FORMS += $$PWD/mainwindow.ui
+
+RESOURCES = $$PWD/app.qrc
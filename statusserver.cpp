@@ -0,0 +1,177 @@
+#include "statusserver.h"
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QUrlQuery>
+#include <QUrl>
+
+#define LONG_POLL_TIMEOUT 30000 // ms
+#define MAX_REQUEST_SIZE 8192
+
+StatusServer::StatusServer(QObject* parent)
+	: QTcpServer(parent),
+	  m_timeoutTimer(this)
+{
+	m_version = 0;
+	m_response = response("200 OK", "{\"version\":0,\"streams\":[]}");
+	m_clock.start();
+
+	m_timeoutTimer.setInterval(1000);
+	connect(&m_timeoutTimer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+	connect(this, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+bool StatusServer::start(quint16 port)
+{
+	if(isListening())
+		stop();
+
+	// never reachable from outside
+	if(!listen(QHostAddress::LocalHost, port))
+		return false;
+
+	m_timeoutTimer.start();
+	return true;
+}
+
+void StatusServer::stop()
+{
+	close();
+	m_timeoutTimer.stop();
+
+	// every client, idle keep-alive connections included
+	for(auto socket : findChildren<QTcpSocket*>()) {
+		socket->disconnectFromHost();
+	}
+	m_waiting.clear();
+}
+
+QByteArray StatusServer::response(const QByteArray& status, const QByteArray& body)
+{
+	return "HTTP/1.1 " + status + "\r\n"
+		   "Content-Type: application/json\r\n"
+		   "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+		   "Cache-Control: no-cache\r\n"
+		   "\r\n" + body;
+}
+
+void StatusServer::publish(const QByteArray& snapshot, qint64 version)
+{
+	m_response = response("200 OK", snapshot);
+	m_version = version;
+
+	// wake up the long-polling clients, then answer what they pipelined behind
+	QList<Waiting> waiting = m_waiting;
+	m_waiting.clear();
+
+	for(auto const& w : waiting) {
+		w.socket->write(m_response);
+		processRequests(w.socket);
+	}
+}
+
+void StatusServer::onNewConnection()
+{
+	while(hasPendingConnections()) {
+		QTcpSocket* socket = nextPendingConnection();
+		connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+		connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+		connect(socket, &QObject::destroyed, this, [this, socket]() {
+			m_requests.remove(socket);
+
+			// pipelined long-polls leave several entries for the same socket
+			for(int i = 0; i < m_waiting.size(); ) {
+				if(m_waiting[i].socket == socket)
+					m_waiting.removeAt(i);
+				else
+					i++;
+			}
+		});
+	}
+}
+
+void StatusServer::onReadyRead()
+{
+	QTcpSocket* socket = static_cast<QTcpSocket*>(sender());
+	m_requests[socket] += socket->readAll();
+
+	processRequests(socket);
+
+	if(m_requests.value(socket).size() > MAX_REQUEST_SIZE) {
+		socket->abort();
+	}
+}
+
+void StatusServer::processRequests(QTcpSocket* socket)
+{
+	QByteArray& request = m_requests[socket];
+
+	// keep-alive: handle every complete request in the buffer, in order: nothing
+	// is answered while a long-poll ahead of it is still waiting
+	int end;
+	while(!isWaiting(socket) && (end = request.indexOf("\r\n\r\n")) != -1) {
+		QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+		request.remove(0, end + 4);
+
+		if(requestLine.size() < 2 || requestLine[0] != "GET") {
+			socket->write(response("405 Method Not Allowed", "{\"error\":\"method not allowed\"}"));
+			continue;
+		}
+
+		handleRequest(socket, requestLine[1]);
+	}
+}
+
+bool StatusServer::isWaiting(QTcpSocket* socket) const
+{
+	for(auto const& w : m_waiting) {
+		if(w.socket == socket)
+			return true;
+	}
+	return false;
+}
+
+void StatusServer::handleRequest(QTcpSocket* socket, const QByteArray& target)
+{
+	QUrl url(QString::fromLatin1(target));
+
+	if(url.path() != "/streams") {
+		socket->write(response("404 Not Found", "{\"error\":\"not found\"}"));
+		return;
+	}
+
+	QUrlQuery query(url);
+	if(query.hasQueryItem("since")) {
+		bool ok;
+		qint64 since = query.queryItemValue("since").toLongLong(&ok);
+
+		// client is up to date, answer on the next change
+		if(ok && since >= m_version) {
+			m_waiting.append({ socket, m_clock.elapsed() + LONG_POLL_TIMEOUT });
+			return;
+		}
+	}
+
+	socket->write(m_response);
+}
+
+void StatusServer::onTimeout()
+{
+	qint64 now = m_clock.elapsed();
+	QList<QTcpSocket*> expired;
+
+	for(int i = 0; i < m_waiting.size(); ) {
+		if(m_waiting[i].deadline <= now) {
+			expired.append(m_waiting[i].socket);
+			m_waiting.removeAt(i);
+		}
+		else {
+			i++;
+		}
+	}
+
+	// nothing new, send the current snapshot and let the client poll again
+	for(auto socket : expired) {
+		socket->write(m_response);
+		processRequests(socket);
+	}
+}
@@ -0,0 +1,55 @@
+#ifndef STATUSSERVER_H
+#define STATUSSERVER_H
+
+#include <QTcpServer>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class QTcpSocket;
+
+/**
+ * @brief Local HTTP endpoint serving the status of every stream as JSON
+ *
+ * GET /streams returns the current snapshot, GET /streams?since=<version>
+ * waits until a newer one is published (or a timeout). Responses are built
+ * once per published snapshot, requests never reach the network.
+ */
+class StatusServer : public QTcpServer
+{
+	Q_OBJECT
+
+	struct Waiting {
+		QTcpSocket* socket;
+		qint64 deadline;
+	};
+
+	QByteArray m_response; // headers + body of the current snapshot
+	qint64 m_version;
+	QHash<QTcpSocket*, QByteArray> m_requests;
+	QList<Waiting> m_waiting;
+	QTimer m_timeoutTimer;
+	QElapsedTimer m_clock;
+
+	void processRequests(QTcpSocket* socket);
+	void handleRequest(QTcpSocket* socket, QByteArray const& target);
+	bool isWaiting(QTcpSocket* socket) const;
+	static QByteArray response(QByteArray const& status, QByteArray const& body);
+
+private slots:
+	void onNewConnection();
+	void onReadyRead();
+	void onTimeout();
+
+public:
+	explicit StatusServer(QObject* parent = nullptr);
+
+	bool start(quint16 port);
+	void stop();
+
+	void publish(QByteArray const& snapshot, qint64 version);
+};
+
+#endif // STATUSSERVER_H
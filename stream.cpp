@@ -1,41 +1,96 @@
 #include "stream.h"
 #include "twitchstream.h"
+#include "streamtee.h"
+#include "streamgroup.h"
 #include "configpath.h"
 #include <QtDebug>
 #include <QFile>
+#include <QDir>
+#include <QCoreApplication>
 
-StreamItem::StreamItem(QTreeWidget* parent, const QUrl& url, const QString& quality)
+StreamItem::StreamItem(QTreeWidgetItem* parent, const QUrl& url, const QString& quality)
 	:QTreeWidgetItem(parent)
 {
 	m_url = url;
 	m_viewerCount = 0;
 	m_online = false;
 	m_watching = false;
+	m_statusKnown = false;
 	m_process = nullptr;
+	m_player = nullptr;
+	m_tee = nullptr;
 
 	setIcon(COLUMN_ICON, QIcon(":twitch.ico")); // twitch icon by default
 	setText(COLUMN_NAME, getName());
 	setText(COLUMN_VIEWERS, "0");
 	setTextAlignment(COLUMN_VIEWERS, Qt::AlignRight | Qt::AlignVCenter);
 
-	m_cbQuality = new QComboBox(parent);
+	m_cbQuality = nullptr;
 	// default qualities
-	m_cbQuality->addItem("worst");
-	m_cbQuality->addItem("best");
+	m_qualities << "worst" << "best";
 
 	// select quality
 	selectQuality(quality);
 
-	parent->setItemWidget(this, COLUMN_QUALITY, m_cbQuality);
-
 	updateWidgetItem();
 }
 
 StreamItem::~StreamItem()
 {
+	// nothing may call back into this item once it's gone
+	m_pollTasks.cancel();
+	m_processTasks.cancel();
+
+	// the tee may still be blocked on a fifo while livestreamer and the player die,
+	// it finishes on its own and frees itself instead of making the GUI thread wait
+	if(m_tee) {
+		m_tee->disconnect(this);
+		m_tee->setParent(nullptr);
+		QObject::connect(m_tee, &QThread::finished, m_tee, &QObject::deleteLater);
+
+		if(m_tee->isRunning()) {
+			m_tee->cancelInput();
+			m_tee->detachPlayer();
+		}
+		else {
+			delete m_tee;
+		}
+	}
+
 	delete m_cbQuality;
 }
 
+void StreamItem::createWidgets()
+{
+	if(m_cbQuality || !treeWidget())
+		return;
+
+	m_cbQuality = new QComboBox(treeWidget());
+	m_cbQuality->addItems(m_qualities);
+	m_cbQuality->setCurrentText(m_quality);
+
+	QObject::connect(m_cbQuality, &QComboBox::currentTextChanged, this, [this](QString const& quality) {
+		if(!quality.isEmpty())
+			m_quality = quality;
+	});
+
+	treeWidget()->setItemWidget(this, COLUMN_QUALITY, m_cbQuality);
+}
+
+void StreamItem::releaseWidgets()
+{
+	if(!m_cbQuality)
+		return;
+
+	// the view deletes the widget it replaces
+	if(treeWidget())
+		treeWidget()->removeItemWidget(this, COLUMN_QUALITY);
+	else
+		delete m_cbQuality;
+
+	m_cbQuality = nullptr;
+}
+
 void StreamItem::updateWidgetItem()
 {
 	if(m_online) {
@@ -72,69 +127,122 @@ void StreamItem::setWatching(bool watching)
 void StreamItem::selectQuality(const QString& quality)
 {
 	m_quality = quality;
-	if(m_cbQuality->findText(quality) == -1) { // quality not found, add an entry for it
-		m_cbQuality->addItem(quality);
+	if(!m_qualities.contains(quality)) { // quality not found, add an entry for it
+		m_qualities.append(quality);
+		if(m_cbQuality)
+			m_cbQuality->addItem(quality);
 	}
-	m_cbQuality->setCurrentText(quality);
+
+	if(m_cbQuality)
+		m_cbQuality->setCurrentText(quality);
 }
 
-void StreamItem::onProcessFinished(int exitStatus)
+void StreamItem::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
 	setWatching(false);
 	updateWidgetItem();
 
-	// livestreamer crashed
-	if(exitStatus != QProcess::NormalExit) {
+	// livestreamer crashed or failed
+	if(exitStatus != QProcess::NormalExit || exitCode != 0) {
 		emit error(ERROR_LS_CRASHED, "");
 	}
 
+	m_process->deleteLater();
 	m_process = nullptr;
 
-	QFile file(CONFIG_PATH + "/" + getName() + ".log");
-	if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
-		return;
+	// livestreamer is gone, make sure the tee thread does not wait for it
+	if(m_tee)
+		m_tee->cancelInput();
 
-	QTextStream out(&file);
-	for(auto s : m_processLog) {
-		out << s << "\n";
+	m_log.close();
+}
+
+void StreamItem::appendLog(const QString& line)
+{
+	// reopened in append mode if something logs after the process finished
+	if(!m_log.isOpen()) {
+		m_log.setFileName(getLogPath());
+		if(!m_log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+			return;
 	}
+
+	m_log.write(line.toUtf8());
+	m_log.write("\n");
+
+	// the log viewer maps the file, nothing may sit in the buffer
+	m_log.flush();
 }
 
 void StreamItem::onProcessStdOut()
 {
-	QString line = m_process->readAllStandardOutput();
+	parseProcessOutput(m_process->readAllStandardOutput());
+}
+
+void StreamItem::parseProcessOutput(QString line)
+{
 	line.remove('\n');
 	line.remove('\r');
 
 	if(!line.isEmpty()) {
-		m_processLog.append(line);
+		appendLog(line);
+		parseOutputLine(line);
+	}
+}
 
-		if(line.startsWith("[cli][info] ")) {
-			line.remove("[cli][info] ");
+void StreamItem::parseOutputLine(QString line)
+{
+	if(line.startsWith("[cli][info] ")) {
+		line.remove("[cli][info] ");
 
-			// update quality combobox to add available qualities
-			if(line.startsWith("Available streams: ")) {
-				line.remove("Available streams: ");
-				auto qualityList = line.split(", ");
+		// update quality combobox to add available qualities
+		if(line.startsWith("Available streams: ")) {
+			line.remove("Available streams: ");
+			auto qualityList = line.split(", ");
 
-				m_cbQuality->clear();
-				m_cbQuality->addItem("best");
-				for(QString s : qualityList) {
-					if(s.count("worst") == 0 && s.count("best") == 0) {
-						m_cbQuality->addItem(s);
-					}
+			QString quality = m_quality;
+
+			m_qualities.clear();
+			m_qualities.append("best");
+			for(QString s : qualityList) {
+				if(s.count("worst") == 0 && s.count("best") == 0) {
+					m_qualities.append(s);
 				}
-				m_cbQuality->addItem("worst");
+			}
+			m_qualities.append("worst");
 
-				// reselect quality since we cleared
-				selectQuality(m_quality);
+			if(m_cbQuality) {
+				m_cbQuality->clear();
+				m_cbQuality->addItems(m_qualities);
 			}
-		}
-		else if(line.startsWith("error: ")) {
-			line.remove("error: ");
-			emit error(ERROR_LS_ERROR, line);
+
+			// reselect quality since we cleared
+			selectQuality(quality);
 		}
 	}
+	else if(line.startsWith("error: ")) {
+		line.remove("error: ");
+		emit error(ERROR_LS_ERROR, line);
+	}
+}
+
+void StreamItem::onTeeFinished()
+{
+	// the tee usually finishes after livestreamer, the line still goes to the session's log
+	appendLog(QString("[tee] %1 MB in %2 s (%3 MB/s)")
+						.arg(m_tee->bytesTransferred() / (1024.0 * 1024.0), 0, 'f', 1)
+						.arg(m_tee->elapsedMs() / 1000.0, 0, 'f', 1)
+						.arg(m_tee->throughput(), 0, 'f', 1));
+
+	if(!m_process)
+		m_log.close();
+
+	m_tee->deleteLater();
+	m_tee = nullptr;
+}
+
+void StreamItem::onTeeError(const QString& errorTxt)
+{
+	emit error(ERROR_RECORDING, errorTxt);
 }
 
 QString StreamItem::getUrl() const
@@ -142,40 +250,163 @@ QString StreamItem::getUrl() const
 	return m_url.toString();
 }
 
+StreamGroup* StreamItem::getGroup() const
+{
+	// parent() alone is ambiguous, QObject has one too
+	return static_cast<StreamGroup*>(QTreeWidgetItem::parent());
+}
+
+QString StreamItem::getLogPath() const
+{
+	return CONFIG_PATH + "/" + getName() + ".log";
+}
+
 bool StreamItem::isOnline() const
 {
 	return m_online;
 }
 
-bool StreamItem::update()
+bool StreamItem::isWatching() const
 {
-	return true;
+	return m_watching;
 }
 
-void StreamItem::watch(QString livestreamerPath)
+int StreamItem::getViewerCount() const
 {
-	// process already running, abort
-	if(m_process)
+	return m_viewerCount;
+}
+
+void StreamItem::setStatus(bool online, int viewerCount)
+{
+	bool live = online && !m_online && m_statusKnown;
+	m_statusKnown = true;
+
+	if(online == m_online && viewerCount == m_viewerCount)
 		return;
 
-	QString program = livestreamerPath;
-	QStringList arguments;
-	arguments << getUrl() << getQuality();
+	m_online = online;
+	m_viewerCount = viewerCount;
+	updateWidgetItem();
+	emit statusChanged();
+
+	if(live)
+		emit wentLive();
+}
+
+bool StreamItem::update()
+{
+	return false; // nothing to poll
+}
+
+void StreamItem::cancelUpdate()
+{
+	m_pollTasks.cancel();
+}
+
+bool StreamItem::startProcess(const QString& program, const QStringList& arguments)
+{
+	// one log per session, the previous one is rotated rather than truncated:
+	// a log viewer may still have it mapped
+	m_log.close();
+	QString logPath = getLogPath();
+	QFile::remove(logPath + ".1");
+	QFile::rename(logPath, logPath + ".1");
+
+	// appends to the old file if it couldn't be renamed
+	m_log.setFileName(logPath);
+	m_log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
 
 	m_process = new QProcess(this);
+	m_processTasks.track(m_process);
 	m_process->start(program, arguments);
 	m_process->setProcessChannelMode(QProcess::MergedChannels);
 
 	if(!m_process->waitForStarted()) {
+		delete m_process;
+		m_process = nullptr;
 		emit error(ERROR_LS_NOT_FOUND, "");
-		return;
+		return false;
 	}
 
 	setWatching(true);
 	updateWidgetItem();
 
-	QObject::connect(m_process, SIGNAL(finished(int)), this, SLOT(onProcessFinished(int)));
+	QObject::connect(m_process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+					 this, &StreamItem::onProcessFinished);
 	QObject::connect(m_process, SIGNAL(readyReadStandardOutput()), this, SLOT(onProcessStdOut()));
+	return true;
+}
+
+void StreamItem::watch(QString livestreamerPath)
+{
+	// process already running, abort
+	if(m_process)
+		return;
+
+	QStringList arguments;
+	arguments << getUrl() << getQuality();
+
+	startProcess(livestreamerPath, arguments);
+}
+
+void StreamItem::watchAndRecord(QString livestreamerPath, QString playerPath, QString recordPath)
+{
+	// process or previous recording still running, abort
+	if(m_process || m_tee)
+		return;
+
+#ifdef Q_OS_UNIX
+	// livestreamer writes into a fifo, the tee thread fans it out to the player's fifo and the file
+	QString fifoBase = QDir::tempPath() + "/livestreamer-ui-" + QString::number(QCoreApplication::applicationPid()) + "-" + getName();
+	m_tee = new StreamTee(fifoBase + ".in", fifoBase + ".out", recordPath, this);
+
+	if(!m_tee->createFifos()) {
+		delete m_tee;
+		m_tee = nullptr;
+		emit error(ERROR_RECORDING, "Recording: failed to create fifos.");
+		return;
+	}
+
+	QObject::connect(m_tee, SIGNAL(finished()), this, SLOT(onTeeFinished()));
+	QObject::connect(m_tee, SIGNAL(error(QString const&)), this, SLOT(onTeeError(QString const&)));
+	m_tee->start();
+
+	QStringList arguments;
+	arguments << getUrl() << getQuality() << "--force" << "--output" << m_tee->getInputPath();
+
+	if(!startProcess(livestreamerPath, arguments)) {
+		m_tee->cancelInput();
+		m_tee->detachPlayer();
+		return;
+	}
+
+	m_player = new QProcess(this);
+	m_processTasks.track(m_player);
+	m_player->start(playerPath, QStringList() << m_tee->getPlayerPath());
+
+	if(!m_player->waitForStarted()) {
+		delete m_player;
+		m_player = nullptr;
+		m_tee->detachPlayer(); // record only
+		emit error(ERROR_PLAYER_NOT_FOUND, "");
+		return;
+	}
+
+	// a player that quits before opening its fifo must not keep the tee waiting for it
+	auto playerFinished = static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished);
+	QObject::connect(m_player, playerFinished, this, [this]() {
+		if(m_tee)
+			m_tee->detachPlayer();
+	});
+	QObject::connect(m_player, playerFinished, m_player, &QObject::deleteLater);
+	QObject::connect(m_player, &QObject::destroyed, this, [this]() { m_player = nullptr; });
+#else
+	Q_UNUSED(playerPath)
+	Q_UNUSED(recordPath)
+
+	emit error(ERROR_RECORDING, "Recording is not supported on this platform.");
+	watch(livestreamerPath);
+#endif
 }
 
 bool StreamItem::operator==(const StreamItem& other) const
@@ -201,7 +432,7 @@ bool StreamItem::operator<(const QTreeWidgetItem& other) const
 	return text(column).toLower() < other.text(column).toLower();
 }
 
-StreamItem* createStreamItem(QTreeWidget* parent, QString const& url, QString const& quality)
+StreamItem* createStreamItem(QTreeWidgetItem* parent, QString const& url, QString const& quality)
 {
 	QUrl qurl(url.toLower(), QUrl::StrictMode);
 
@@ -220,3 +451,26 @@ StreamItem* createStreamItem(QTreeWidget* parent, QString const& url, QString co
 
 	return new StreamItem(parent, qurl, quality); // should never happen
 }
+
+StatusParser streamStatusRequest(const QString& url, QNetworkRequest* request)
+{
+	QUrl qurl(url.toLower(), QUrl::StrictMode);
+
+	// same dispatch as createStreamItem
+	if(qurl.isValid() && qurl.host().endsWith(TWITCH_NAME)) {
+		*request = TwitchStreamItem::statusRequest(TwitchStreamItem::channelName(qurl));
+		return &TwitchStreamItem::parseStatus;
+	}
+
+	return nullptr;
+}
+
+QString streamName(const QString& url)
+{
+	QUrl qurl(url.toLower(), QUrl::StrictMode);
+
+	if(qurl.isValid() && qurl.host().endsWith(TWITCH_NAME))
+		return TwitchStreamItem::channelName(qurl);
+
+	return url;
+}
@@ -8,6 +8,11 @@
 #include <QProcess>
 #include <QUrl>
 #include <QComboBox>
+#include <QFile>
+#include "taskscope.h"
+
+class StreamTee;
+class StreamGroup;
 
 /**
  * @brief Base stream class
@@ -17,27 +22,41 @@ class StreamItem: public QObject, public QTreeWidgetItem
 	Q_OBJECT
 
 	QProcess* m_process;
-	QStringList m_processLog;
+	QProcess* m_player;
+	StreamTee* m_tee;
+	QFile m_log; // livestreamer output, written as it arrives
+	bool m_statusKnown;
 
 	void setWatching(bool watching);
 	void selectQuality(QString const& quality);
+	void appendLog(QString const& line);
 
 private slots:
-	void onProcessFinished(int exitStatus);
+	void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
 	void onProcessStdOut();
+	void onTeeFinished();
+	void onTeeError(QString const& errorTxt);
 
 signals:
 	void error(int errorType, QString const& errorTxt);
+	void statusChanged();
+	void wentLive(); // came online, not sent for the first status of the item
+	void updated(); // an update() request completed, successfully or not
 
 protected:
+	TaskScope m_pollTasks; // update() requests
+	TaskScope m_processTasks; // livestreamer and player
+
 	QUrl m_url;
 	int m_viewerCount;
 	bool m_online;
 	bool m_watching;
-	QComboBox* m_cbQuality;
+	QComboBox* m_cbQuality; // only while the row is visible, see createWidgets()
 	QString m_quality;
+	QStringList m_qualities; // available qualities, as listed in the combobox
 
 	void updateWidgetItem();
+	bool startProcess(QString const& program, QStringList const& arguments);
 
 public:
 	enum {
@@ -50,18 +69,47 @@ public:
 	enum {
 		ERROR_LS_NOT_FOUND,
 		ERROR_LS_CRASHED,
-		ERROR_LS_ERROR
+		ERROR_LS_ERROR,
+		ERROR_PLAYER_NOT_FOUND,
+		ERROR_RECORDING
 	};
 
-	StreamItem(QTreeWidget* parent, QUrl const& url, QString const& quality);
+	StreamItem(QTreeWidgetItem* parent, QUrl const& url, QString const& quality);
 	virtual ~StreamItem();
 
-	virtual bool update();
+	/**
+	 * @brief Create/destroy the row widgets, rows of collapsed groups don't have any
+	 */
+	void createWidgets();
+	void releaseWidgets();
+
+	virtual bool update(); // true if a request was sent, updated() follows
+	void cancelUpdate(); // drop the pending update() request, updated() won't follow
 	void watch(QString livestreamerPath);
+	void watchAndRecord(QString livestreamerPath, QString playerPath, QString recordPath);
 	QString getUrl() const;
+	StreamGroup* getGroup() const; // the group row the stream is in, if any
+	QString getLogPath() const;
 	virtual QString getName() const;
 	QString getQuality() const;
 	bool isOnline() const;
+	bool isWatching() const;
+
+	/**
+	 * @brief Set the online status and viewer count, statusChanged() if either changed
+	 */
+	void setStatus(bool online, int viewerCount);
+
+	/**
+	 * @brief Handle a chunk of livestreamer output (log it, pick up qualities and errors)
+	 */
+	void parseProcessOutput(QString line);
+
+	/**
+	 * @brief Pick up qualities and errors from one line of output, without logging it
+	 */
+	void parseOutputLine(QString line);
+	int getViewerCount() const;
 
 	bool operator==(StreamItem const& other) const;
 	virtual bool operator<(const QTreeWidgetItem &other) const;
@@ -91,6 +139,22 @@ public:
  * @param url
  * @return Stream*
  */
-StreamItem* createStreamItem(QTreeWidget* parent, QString const& url, QString const& quality);
+StreamItem* createStreamItem(QTreeWidgetItem* parent, QString const& url, QString const& quality);
+
+/**
+ * @brief Parses a status reply from a stream host
+ */
+typedef bool (*StatusParser)(QByteArray const& reply, bool* online, int* viewerCount);
+
+/**
+ * @brief Status request for a stream url, without creating its item
+ * @return the parser for the reply, nullptr if the host isn't supported
+ */
+StatusParser streamStatusRequest(QString const& url, QNetworkRequest* request);
+
+/**
+ * @brief Name a stream url's item would show
+ */
+QString streamName(QString const& url);
 
 #endif // STREAM_H
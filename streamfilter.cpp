@@ -0,0 +1,188 @@
+#include "streamfilter.h"
+#include "stream.h"
+#include <climits>
+
+StreamFilter::StreamFilter()
+{
+	m_minViewers = 0;
+	m_maxViewers = INT_MAX;
+	m_onlineOnly = false;
+}
+
+quint64 StreamFilter::trigram(const QString& str, int pos)
+{
+	return ((quint64)str[pos].unicode() << 32) |
+		   ((quint64)str[pos + 1].unicode() << 16) |
+		   (quint64)str[pos + 2].unicode();
+}
+
+void StreamFilter::setVisible(StreamItem* stream, bool visible)
+{
+	if(visible) {
+		m_visible.insert(stream);
+	}
+	else {
+		m_visible.remove(stream);
+	}
+
+	if(stream->isHidden() == visible)
+		stream->setHidden(!visible);
+}
+
+void StreamFilter::insert(StreamItem* stream)
+{
+	QString name = stream->getName().toLower();
+	m_names.insert(stream, name);
+
+	for(int i = 0; i + 2 < name.size(); i++) {
+		m_postings[trigram(name, i)].insert(stream);
+	}
+
+	setVisible(stream, matches(stream));
+}
+
+void StreamFilter::remove(StreamItem* stream)
+{
+	auto it = m_names.find(stream);
+	if(it == m_names.end())
+		return;
+
+	QString const& name = it.value();
+	for(int i = 0; i + 2 < name.size(); i++) {
+		auto posting = m_postings.find(trigram(name, i));
+		if(posting != m_postings.end()) {
+			posting->remove(stream);
+			if(posting->isEmpty())
+				m_postings.erase(posting);
+		}
+	}
+
+	m_names.erase(it);
+	m_visible.remove(stream);
+}
+
+void StreamFilter::clear()
+{
+	m_postings.clear();
+	m_names.clear();
+	m_visible.clear();
+}
+
+bool StreamFilter::setQuery(const QString& query)
+{
+	QStringList words;
+	int minViewers = 0;
+	int maxViewers = INT_MAX;
+
+	for(QString word : query.toLower().split(" ", QString::SkipEmptyParts)) {
+		// bounds are computed wide and clamped to what a viewer count can be
+		bool ok = false;
+		if(word.startsWith(">")) {
+			qint64 n = word.mid(1).toLongLong(&ok);
+			if(ok) {
+				minViewers = n >= INT_MAX ? INT_MAX : static_cast<int>(qMax<qint64>(0, n + 1));
+				continue;
+			}
+		}
+		else if(word.startsWith("<")) {
+			qint64 n = word.mid(1).toLongLong(&ok);
+			if(ok) {
+				maxViewers = n <= 0 ? 0 : static_cast<int>(qMin<qint64>(n - 1, INT_MAX));
+				continue;
+			}
+		}
+
+		if(!words.contains(word))
+			words.append(word);
+	}
+
+	if(words == m_words && minViewers == m_minViewers && maxViewers == m_maxViewers)
+		return false;
+
+	m_words = words;
+	m_minViewers = minViewers;
+	m_maxViewers = maxViewers;
+	return true;
+}
+
+void StreamFilter::setOnlineOnly(bool onlineOnly)
+{
+	m_onlineOnly = onlineOnly;
+}
+
+bool StreamFilter::matches(StreamItem* stream) const
+{
+	if(m_onlineOnly && !stream->isOnline())
+		return false;
+
+	int viewers = stream->getViewerCount();
+	if(viewers < m_minViewers || viewers > m_maxViewers)
+		return false;
+
+	QString const name = m_names.value(stream);
+	for(auto const& word : m_words) {
+		if(!name.contains(word))
+			return false;
+	}
+
+	return true;
+}
+
+void StreamFilter::update(StreamItem* stream)
+{
+	if(!m_names.contains(stream))
+		return;
+
+	bool visible = matches(stream);
+	if(visible != m_visible.contains(stream))
+		setVisible(stream, visible);
+}
+
+void StreamFilter::apply()
+{
+	QSet<StreamItem*> result;
+
+	// the smallest posting list over the trigrams of every word, matches() checks the rest
+	QSet<StreamItem*> const* smallest = nullptr;
+	bool indexed = false;
+	bool missing = false; // a trigram no name has, nothing can match
+
+	for(auto const& word : m_words) {
+		for(int i = 0; i + 2 < word.size() && !missing; i++) {
+			auto it = m_postings.constFind(trigram(word, i));
+			if(it == m_postings.constEnd())
+				missing = true;
+			else if(!smallest || it->size() < smallest->size())
+				smallest = &it.value();
+			indexed = true;
+		}
+	}
+
+	if(indexed) {
+		if(!missing) {
+			for(auto s : *smallest) {
+				if(matches(s))
+					result.insert(s);
+			}
+		}
+	}
+	else {
+		// no word long enough to use the index
+		for(auto it = m_names.constBegin(); it != m_names.constEnd(); ++it) {
+			if(matches(it.key()))
+				result.insert(it.key());
+		}
+	}
+
+	// only touch the items whose visibility changed
+	QSet<StreamItem*> hide = m_visible;
+	hide.subtract(result);
+	for(auto s : hide) {
+		setVisible(s, false);
+	}
+
+	for(auto s : result) {
+		if(!m_visible.contains(s))
+			setVisible(s, true);
+	}
+}
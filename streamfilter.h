@@ -0,0 +1,60 @@
+#ifndef STREAMFILTER_H
+#define STREAMFILTER_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class StreamItem;
+
+/**
+ * @brief Incremental name index + online/viewer predicates over the stream list
+ *
+ * Names are indexed by trigram so a keystroke only has to verify the streams
+ * sharing the query trigrams instead of scanning the whole list.
+ * Visibility is applied as a diff against the previous result.
+ */
+class StreamFilter
+{
+	QHash<quint64, QSet<StreamItem*>> m_postings; // trigram -> streams
+	QHash<StreamItem*, QString> m_names; // indexed (lowercase) names
+	QSet<StreamItem*> m_visible;
+
+	QStringList m_words; // all of them must be in the name
+	int m_minViewers;
+	int m_maxViewers;
+	bool m_onlineOnly;
+
+	static quint64 trigram(QString const& str, int pos);
+	void setVisible(StreamItem* stream, bool visible);
+
+public:
+	StreamFilter();
+
+	void insert(StreamItem* stream);
+	void remove(StreamItem* stream);
+	void clear();
+
+	/**
+	 * @brief Parse a query: every word must be in the name, ">N" and "<N" bound the viewer count
+	 * @return true if the query changed
+	 */
+	bool setQuery(QString const& query);
+	void setOnlineOnly(bool onlineOnly);
+
+	bool matches(StreamItem* stream) const;
+
+	/**
+	 * @brief Re-evaluate a single stream after a status change
+	 */
+	void update(StreamItem* stream);
+
+	/**
+	 * @brief Re-run the query over the index and show/hide the streams that changed
+	 */
+	void apply();
+};
+
+#endif // STREAMFILTER_H
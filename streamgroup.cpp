@@ -0,0 +1,147 @@
+#include "streamgroup.h"
+#include "stream.h"
+#include <QHeaderView>
+#include <QFont>
+
+StreamGroup::StreamGroup(QTreeWidget* parent, const QString& name, int pollInterval)
+	: QTreeWidgetItem(parent),
+	  m_pollTimer(this),
+	  m_collapsedTasks(this)
+{
+	m_name = name;
+	m_pollInterval = pollInterval;
+
+	QFont boldFont = font(StreamItem::COLUMN_NAME);
+	boldFont.setBold(true);
+	setFont(StreamItem::COLUMN_NAME, boldFont);
+	setTextAlignment(StreamItem::COLUMN_VIEWERS, Qt::AlignRight | Qt::AlignVCenter);
+
+	connect(&m_pollTimer, SIGNAL(timeout()), this, SIGNAL(pollRequested()));
+
+	updateWidgetItem();
+}
+
+QString StreamGroup::getName() const
+{
+	return m_name;
+}
+
+int StreamGroup::getPollInterval() const
+{
+	return m_pollInterval;
+}
+
+void StreamGroup::setPollInterval(int seconds)
+{
+	m_pollInterval = seconds;
+
+	if(m_pollTimer.isActive())
+		m_pollTimer.start(m_pollInterval * 1000);
+}
+
+void StreamGroup::setActive(bool active)
+{
+	if(active)
+		m_pollTimer.stop();
+	else
+		m_pollTimer.start(m_pollInterval * 1000);
+}
+
+QVector<StreamItem*> StreamGroup::getStreams() const
+{
+	QVector<StreamItem*> streams;
+	streams.reserve(childCount());
+
+	for(int i = 0; i < childCount(); i++) {
+		streams.append(static_cast<StreamItem*>(child(i)));
+	}
+
+	return streams;
+}
+
+int StreamGroup::streamCount() const
+{
+	return childCount() + m_collapsed.size();
+}
+
+void StreamGroup::updateWidgetItem()
+{
+	setText(StreamItem::COLUMN_NAME, m_name);
+	setText(StreamItem::COLUMN_VIEWERS, QString("(%1)").arg(streamCount()));
+
+	// records have no rows, the group must still be expandable
+	setChildIndicatorPolicy(m_collapsed.isEmpty() ? QTreeWidgetItem::DontShowIndicatorWhenChildless
+												  : QTreeWidgetItem::ShowIndicator);
+}
+
+void StreamGroup::addCollapsed(const CollapsedStream& stream)
+{
+	// same form as StreamItem::getUrl() so duplicates can be found by url
+	CollapsedStream entry = stream;
+	QUrl url(stream.url.toLower(), QUrl::StrictMode);
+	if(url.isValid())
+		entry.url = url.toString();
+
+	m_collapsed.append(entry);
+}
+
+QVector<CollapsedStream> StreamGroup::takeCollapsed()
+{
+	m_collapsedTasks.cancel();
+
+	QVector<CollapsedStream> streams;
+	streams.swap(m_collapsed);
+	return streams;
+}
+
+const QVector<CollapsedStream>& StreamGroup::getCollapsed() const
+{
+	return m_collapsed;
+}
+
+void StreamGroup::pollCollapsed()
+{
+	// one reply per record, like StreamItem::update()
+	m_collapsedTasks.cancel();
+
+	for(int i = 0; i < m_collapsed.size(); i++) {
+		QNetworkRequest request;
+		StatusParser parse = streamStatusRequest(m_collapsed[i].url, &request);
+		if(!parse)
+			continue;
+
+		// appending keeps the indexes, anything else cancels first
+		m_collapsedTasks.get(request, [this, i, parse](QNetworkReply* reply) {
+			bool online;
+			int viewers;
+
+			if(reply->error() != QNetworkReply::NoError || !parse(reply->readAll(), &online, &viewers))
+				return;
+
+			CollapsedStream& s = m_collapsed[i];
+			if(s.known && s.online == online && s.viewers == viewers)
+				return;
+
+			bool live = s.known && online && !s.online;
+			s.known = true;
+			s.online = online;
+			s.viewers = viewers;
+
+			if(live)
+				emit collapsedWentLive(streamName(s.url), viewers);
+			emit collapsedStatusChanged();
+		});
+	}
+}
+
+bool StreamGroup::operator<(const QTreeWidgetItem& other) const
+{
+	// groups stay in name order whatever the sort column and order
+	QString name = text(StreamItem::COLUMN_NAME).toLower();
+	QString otherName = other.text(StreamItem::COLUMN_NAME).toLower();
+
+	if(treeWidget() && treeWidget()->header()->sortIndicatorOrder() == Qt::DescendingOrder)
+		return otherName < name;
+
+	return name < otherName;
+}
@@ -0,0 +1,83 @@
+#ifndef STREAMGROUP_H
+#define STREAMGROUP_H
+
+#include <QObject>
+#include <QTreeWidget>
+#include <QTimer>
+#include <QVector>
+#include "taskscope.h"
+
+class StreamItem;
+
+#define DEFAULT_GROUP_NAME "Streams"
+#define DEFAULT_GROUP_POLL_INTERVAL 600 // seconds
+
+/**
+ * @brief A stream of a group that hasn't been expanded yet, no item exists for it
+ */
+struct CollapsedStream {
+	QString url;
+	QString quality;
+	bool known; // status polled at least once
+	bool online;
+	int viewers;
+};
+
+/**
+ * @brief Named group of streams, a top-level row of the stream list
+ *
+ * While expanded its streams have row widgets and follow the main update
+ * timer. While collapsed they have no widgets and are polled by the group's
+ * own (slower) timer. A group loaded collapsed only keeps records of its
+ * streams and polls them itself until it is first expanded.
+ */
+class StreamGroup : public QObject, public QTreeWidgetItem
+{
+	Q_OBJECT
+
+	QString m_name;
+	int m_pollInterval;
+	QTimer m_pollTimer;
+
+	QVector<CollapsedStream> m_collapsed;
+	TaskScope m_collapsedTasks; // cancelled before the records change
+
+signals:
+	void pollRequested();
+	void collapsedStatusChanged();
+	void collapsedWentLive(QString const& name, int viewers);
+
+public:
+	StreamGroup(QTreeWidget* parent, QString const& name, int pollInterval);
+
+	QString getName() const;
+	int getPollInterval() const;
+	void setPollInterval(int seconds);
+
+	/**
+	 * @brief Expanded groups are active, collapsed ones poll on their own timer
+	 */
+	void setActive(bool active);
+
+	QVector<StreamItem*> getStreams() const;
+	int streamCount() const; // items and records
+	void updateWidgetItem(); // name and stream count
+
+	/**
+	 * @brief Records are materialized by the owner when the group is expanded
+	 *
+	 * Neither call updates the stream count shown, updateWidgetItem() does.
+	 */
+	void addCollapsed(CollapsedStream const& stream);
+	QVector<CollapsedStream> takeCollapsed();
+	QVector<CollapsedStream> const& getCollapsed() const;
+
+	/**
+	 * @brief Poll the records, replies still pending from the last poll are dropped
+	 */
+	void pollCollapsed();
+
+	virtual bool operator<(const QTreeWidgetItem &other) const;
+};
+
+#endif // STREAMGROUP_H
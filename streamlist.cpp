@@ -0,0 +1,71 @@
+#include "streamlist.h"
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+bool readStreamList(const QString& path, QVector<StreamListGroup>* groups)
+{
+	QFile file(path);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return false;
+
+	// streams before the first group header
+	groups->append({ QString(), 0, false, {} });
+
+	while(!file.atEnd()) {
+		QString line = file.readLine();
+		line.remove('\n');
+
+		if(line.startsWith("[")) {
+			int end = line.indexOf(']');
+			if(end == -1)
+				continue;
+
+			QStringList options = line.mid(end + 1).split(" ", QString::SkipEmptyParts);
+			bool ok = false;
+			int interval = options.isEmpty() ? 0 : options.first().toInt(&ok);
+
+			groups->append({ line.mid(1, end - 1).trimmed(), ok ? interval : 0, options.contains("collapsed"), {} });
+			continue;
+		}
+
+		QStringList split = line.split(" ", QString::SkipEmptyParts);
+
+		if(split.isEmpty())
+			continue;
+
+		QString url = split.first();
+		QString quality = "best";
+		if(split.size() > 1) {
+			quality = split.last();
+		}
+
+		groups->last().streams.append({ url, quality });
+	}
+
+	return true;
+}
+
+bool writeStreamList(const QString& path, const QVector<StreamListGroup>& groups)
+{
+	QFile file(path);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+
+	QTextStream out(&file);
+
+	for(auto const& g : groups) {
+		if(!g.name.isEmpty()) {
+			out << "[" << g.name << "] " << g.pollInterval;
+			if(g.collapsed)
+				out << " collapsed";
+			out << "\n";
+		}
+
+		for(auto const& s : g.streams) {
+			out << s.url << " " << s.quality << "\n";
+		}
+	}
+
+	return true;
+}
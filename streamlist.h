@@ -0,0 +1,34 @@
+#ifndef STREAMLIST_H
+#define STREAMLIST_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief A group of the streams file, with its streams in file order
+ */
+struct StreamListGroup {
+	struct Entry {
+		QString url;
+		QString quality;
+	};
+
+	QString name; // empty for the streams before the first header (default group)
+	int pollInterval; // seconds, 0 if not given
+	bool collapsed;
+	QVector<Entry> streams;
+};
+
+/**
+ * @brief Read a streams file: "[name] <collapsed update interval> [collapsed]" group headers, each followed by "url quality" lines
+ * @return false if the file can't be opened
+ */
+bool readStreamList(QString const& path, QVector<StreamListGroup>* groups);
+
+/**
+ * @brief Write groups in the form readStreamList() reads
+ * @return false if the file can't be opened
+ */
+bool writeStreamList(QString const& path, QVector<StreamListGroup> const& groups);
+
+#endif // STREAMLIST_H
@@ -0,0 +1,247 @@
+#include "streamtee.h"
+#include <QElapsedTimer>
+#include <QFile>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/stat.h>
+#endif
+
+#define TEE_CHUNK_SIZE (64 * 1024)
+#define FIFO_OPEN_RETRY 20 // ms between attempts to open a fifo whose other end isn't there yet
+
+StreamTee::StreamTee(QString const& inputPath, QString const& playerPath, QString const& recordPath, QObject* parent)
+	: QThread(parent),
+	  m_inputPath(inputPath),
+	  m_playerPath(playerPath),
+	  m_recordPath(recordPath),
+	  m_bytes(0),
+	  m_elapsed(0),
+	  m_inputCancelled(0),
+	  m_playerDetached(0),
+	  m_inputOpened(0)
+{
+}
+
+StreamTee::~StreamTee()
+{
+	// StreamItem lets a running tee finish detached and free itself, this is only a safety net
+	if(isRunning()) {
+		cancelInput();
+		detachPlayer();
+		wait();
+	}
+
+	QFile::remove(m_inputPath);
+	QFile::remove(m_playerPath);
+}
+
+bool StreamTee::createFifos()
+{
+#ifdef Q_OS_UNIX
+	QFile::remove(m_inputPath);
+	QFile::remove(m_playerPath);
+
+	if(mkfifo(QFile::encodeName(m_inputPath).constData(), 0600) != 0)
+		return false;
+	if(mkfifo(QFile::encodeName(m_playerPath).constData(), 0600) != 0)
+		return false;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void StreamTee::cancelInput()
+{
+#ifdef Q_OS_UNIX
+	m_inputCancelled.fetchAndStoreOrdered(1);
+
+	// the thread sees the flag before its open(), or it is (about to be) blocked in it:
+	// opening the write end then lets open() return, closing it gives EOF
+	while(isRunning() && !m_inputOpened.loadAcquire()) {
+		int fd = ::open(QFile::encodeName(m_inputPath).constData(), O_WRONLY | O_NONBLOCK);
+		if(fd != -1) {
+			::close(fd);
+			break;
+		}
+		QThread::msleep(1);
+	}
+#endif
+}
+
+void StreamTee::detachPlayer()
+{
+	// the thread stops waiting for the player, or stops writing to it at its next chunk
+	m_playerDetached.fetchAndStoreOrdered(1);
+}
+
+QString StreamTee::getInputPath() const
+{
+	return m_inputPath;
+}
+
+QString StreamTee::getPlayerPath() const
+{
+	return m_playerPath;
+}
+
+qint64 StreamTee::bytesTransferred() const
+{
+	return m_bytes.load();
+}
+
+qint64 StreamTee::elapsedMs() const
+{
+	return m_elapsed.load();
+}
+
+double StreamTee::throughput() const
+{
+	qint64 ms = elapsedMs();
+	if(ms <= 0)
+		return 0.0;
+	return (bytesTransferred() / (1024.0 * 1024.0)) / (ms / 1000.0);
+}
+
+void StreamTee::run()
+{
+#ifdef Q_OS_UNIX
+	// a closed player must give us EPIPE, not kill the app
+	sigset_t set;
+	sigemptyset(&set);
+	sigaddset(&set, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+	if(m_inputCancelled.loadAcquire())
+		return;
+
+	int in = ::open(QFile::encodeName(m_inputPath).constData(), O_RDONLY);
+	m_inputOpened.storeRelease(1);
+	if(in == -1) {
+		emit error("Recording: failed to open livestreamer output.");
+		return;
+	}
+
+	// livestreamer never started, nothing to record
+	if(m_inputCancelled.loadAcquire()) {
+		::close(in);
+		return;
+	}
+
+	int file = ::open(QFile::encodeName(m_recordPath).constData(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(file == -1) {
+		emit error("Recording: failed to create " + m_recordPath);
+		::close(in);
+		return;
+	}
+
+	// a blocking open would wait forever for a player that never comes, poll for it instead
+	int out = -1;
+	while(!m_playerDetached.loadAcquire() && !m_inputCancelled.loadAcquire()) {
+		out = ::open(QFile::encodeName(m_playerPath).constData(), O_WRONLY | O_NONBLOCK);
+		if(out != -1) {
+			// writes block again, a slow player throttles livestreamer
+			fcntl(out, F_SETFL, fcntl(out, F_GETFL) & ~O_NONBLOCK);
+			break;
+		}
+		if(errno != ENXIO && errno != EINTR)
+			break;
+		msleep(FIFO_OPEN_RETRY);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+#ifdef Q_OS_LINUX
+	for(;;) {
+		ssize_t len;
+
+		if(out != -1 && m_playerDetached.loadAcquire()) {
+			::close(out);
+			out = -1;
+		}
+
+		if(out != -1) {
+			// duplicate what is in the input pipe to the player without consuming it
+			len = tee(in, out, TEE_CHUNK_SIZE, 0);
+			if(len < 0) {
+				if(errno == EINTR)
+					continue;
+				// player closed, keep recording
+				::close(out);
+				out = -1;
+				continue;
+			}
+			if(len == 0)
+				break;
+		}
+		else {
+			len = TEE_CHUNK_SIZE;
+		}
+
+		// then consume it into the recording file
+		ssize_t remaining = len;
+		while(remaining > 0) {
+			ssize_t moved = splice(in, nullptr, file, nullptr, remaining, SPLICE_F_MOVE | SPLICE_F_MORE);
+			if(moved < 0 && errno == EINTR)
+				continue;
+			if(moved <= 0)
+				break;
+
+			remaining -= moved;
+			m_bytes.fetchAndAddRelaxed(moved);
+		}
+
+		// input EOF (only reachable without a player) or write error
+		if(remaining == len)
+			break;
+	}
+#else
+	// no splice outside linux, go through a buffer
+	char buffer[TEE_CHUNK_SIZE];
+	for(;;) {
+		ssize_t len = ::read(in, buffer, sizeof(buffer));
+		if(len < 0 && errno == EINTR)
+			continue;
+		if(len <= 0)
+			break;
+
+		if(out != -1 && m_playerDetached.loadAcquire()) {
+			::close(out);
+			out = -1;
+		}
+
+		if(out != -1) {
+			ssize_t written = 0;
+			while(written < len) {
+				ssize_t w = ::write(out, buffer + written, len - written);
+				if(w < 0 && errno == EINTR)
+					continue;
+				if(w <= 0) {
+					::close(out);
+					out = -1;
+					break;
+				}
+				written += w;
+			}
+		}
+
+		if(::write(file, buffer, len) != len)
+			break;
+
+		m_bytes.fetchAndAddRelaxed(len);
+	}
+#endif
+
+	m_elapsed.store(timer.elapsed());
+
+	if(out != -1)
+		::close(out);
+	::close(file);
+	::close(in);
+#endif
+}
@@ -0,0 +1,65 @@
+#ifndef STREAMTEE_H
+#define STREAMTEE_H
+
+#include <QThread>
+#include <QString>
+#include <QAtomicInteger>
+
+/**
+ * @brief Fans the bytes livestreamer writes into a fifo out to the player's fifo and a recording file
+ *
+ * On Linux the data is moved with tee()/splice() so it never goes through a
+ * user-space buffer. Both sides block, so a slow player or disk throttles
+ * livestreamer instead of buffering in memory. If the player goes away the
+ * recording carries on.
+ */
+class StreamTee : public QThread
+{
+	Q_OBJECT
+
+	QString m_inputPath;
+	QString m_playerPath;
+	QString m_recordPath;
+
+	QAtomicInteger<qint64> m_bytes;
+	QAtomicInteger<qint64> m_elapsed;
+
+	// set from the GUI thread, checked by the thread before each blocking open
+	QAtomicInt m_inputCancelled;
+	QAtomicInt m_playerDetached;
+	QAtomicInt m_inputOpened;
+
+protected:
+	void run();
+
+signals:
+	void error(QString const& errorTxt);
+
+public:
+	StreamTee(QString const& inputPath, QString const& playerPath, QString const& recordPath, QObject* parent = nullptr);
+	~StreamTee();
+
+	/**
+	 * @brief Create the input and player fifos
+	 */
+	bool createFifos();
+
+	/**
+	 * @brief Unblock the thread if livestreamer never opened its output
+	 */
+	void cancelInput();
+
+	/**
+	 * @brief Unblock the thread if the player never opened its input, the recording goes on
+	 */
+	void detachPlayer();
+
+	QString getInputPath() const;
+	QString getPlayerPath() const;
+
+	qint64 bytesTransferred() const;
+	qint64 elapsedMs() const;
+	double throughput() const; // MB/s
+};
+
+#endif // STREAMTEE_H
@@ -0,0 +1,68 @@
+#include "taskscope.h"
+#include <QCoreApplication>
+
+QNetworkAccessManager* networkManager()
+{
+	// one manager (and one connection pool) for all streams, owned by the application
+	static QNetworkAccessManager* manager = new QNetworkAccessManager(QCoreApplication::instance());
+	return manager;
+}
+
+TaskScope::TaskScope(QObject* parent)
+	: QObject(parent)
+{
+}
+
+TaskScope::~TaskScope()
+{
+	cancel();
+}
+
+void TaskScope::track(QProcess* process)
+{
+	m_processes.append(process);
+	connect(process, &QObject::destroyed, this, [this, process]() { m_processes.removeOne(process); });
+}
+
+void TaskScope::abort(QNetworkReply* reply)
+{
+	if(!m_replies.removeOne(reply))
+		return;
+
+	// drop the callback first, abort() emits finished()
+	disconnect(reply, nullptr, this, nullptr);
+	reply->abort();
+	reply->deleteLater();
+}
+
+void TaskScope::cancel()
+{
+	QList<QNetworkReply*> replies = m_replies;
+
+	for(auto reply : replies) {
+		abort(reply);
+	}
+
+	QList<QProcess*> processes = m_processes;
+	m_processes.clear();
+
+	for(auto process : processes) {
+		// no callbacks and no owner any more (~QProcess would wait for it), it frees itself once dead
+		process->disconnect();
+		process->setParent(nullptr);
+
+		if(process->state() == QProcess::NotRunning) {
+			process->deleteLater();
+			continue;
+		}
+
+		connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+				process, &QObject::deleteLater);
+		process->kill();
+	}
+}
+
+int TaskScope::pending() const
+{
+	return m_replies.size() + m_processes.size();
+}
@@ -0,0 +1,67 @@
+#ifndef TASKSCOPE_H
+#define TASKSCOPE_H
+
+#include <QObject>
+#include <QList>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QProcess>
+
+/**
+ * @brief Network manager shared by every stream
+ */
+QNetworkAccessManager* networkManager();
+
+/**
+ * @brief Owns the network requests and processes started on behalf of an object
+ *
+ * Callbacks only run while the scope is alive. cancel() (or destroying the
+ * scope) aborts everything still in flight and no callback fires afterwards.
+ */
+class TaskScope : public QObject
+{
+	Q_OBJECT
+
+	QList<QNetworkReply*> m_replies;
+	QList<QProcess*> m_processes;
+
+public:
+	explicit TaskScope(QObject* parent = nullptr);
+	~TaskScope();
+
+	/**
+	 * @brief GET request, callback(QNetworkReply*) runs once when it finishes, the reply is freed afterwards
+	 */
+	template<typename Callback>
+	QNetworkReply* get(QNetworkRequest const& request, Callback callback);
+
+	/**
+	 * @brief Kill the process on cancel(), it is freed when it finishes or gets cancelled
+	 */
+	void track(QProcess* process);
+
+	/**
+	 * @brief Abort one request, its callback doesn't run
+	 */
+	void abort(QNetworkReply* reply);
+
+	void cancel();
+	int pending() const;
+};
+
+template<typename Callback>
+QNetworkReply* TaskScope::get(QNetworkRequest const& request, Callback callback)
+{
+	QNetworkReply* reply = networkManager()->get(request);
+	m_replies.append(reply);
+
+	connect(reply, &QNetworkReply::finished, this, [this, reply, callback]() {
+		m_replies.removeOne(reply);
+		callback(reply);
+		reply->deleteLater();
+	});
+
+	return reply;
+}
+
+#endif // TASKSCOPE_H
@@ -0,0 +1,156 @@
+#include "traypoller.h"
+#include "stream.h"
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#define TRAY_TICK 10000 // ms, the shortest group interval
+
+TrayPoller::TrayPoller(QObject* parent)
+	: QObject(parent),
+	  m_tasks(this),
+	  m_timer(this)
+{
+	m_updateInterval = 0;
+
+	m_timer.setInterval(TRAY_TICK);
+	connect(&m_timer, SIGNAL(timeout()), this, SLOT(onTimer()));
+}
+
+void TrayPoller::start(const QVector<GroupRecord>& groups, const QVector<StreamRecord>& streams, int updateInterval)
+{
+	m_groups = groups;
+	m_streams = streams;
+	m_replies.fill(nullptr, m_streams.size());
+	m_updateInterval = updateInterval;
+
+	// the view polled everything recently, start counting from now
+	m_clock.start();
+	for(auto& g : m_groups) {
+		g.lastPoll = 0;
+	}
+
+	m_timer.start();
+}
+
+void TrayPoller::stop()
+{
+	m_timer.stop();
+	m_tasks.cancel();
+	m_replies.fill(nullptr);
+}
+
+void TrayPoller::clear()
+{
+	stop();
+	m_groups.clear();
+	m_streams.clear();
+	m_replies.clear();
+}
+
+const QVector<GroupRecord>& TrayPoller::getGroups() const
+{
+	return m_groups;
+}
+
+const QVector<StreamRecord>& TrayPoller::getStreams() const
+{
+	return m_streams;
+}
+
+int TrayPoller::onlineCount() const
+{
+	int count = 0;
+	for(auto const& s : m_streams) {
+		if(s.online)
+			count++;
+	}
+	return count;
+}
+
+void TrayPoller::onTimer()
+{
+	qint64 now = m_clock.elapsed();
+
+	for(int i = 0; i < m_groups.size(); i++) {
+		GroupRecord& g = m_groups[i];
+		int interval = g.expanded ? m_updateInterval : g.pollInterval;
+
+		if(interval > 0 && now - g.lastPoll >= interval * 1000LL) {
+			g.lastPoll = now;
+			poll(i);
+		}
+	}
+}
+
+void TrayPoller::poll(int group)
+{
+	for(int i = 0; i < m_streams.size(); i++) {
+		if(m_streams[i].group != group)
+			continue;
+
+		QNetworkRequest request;
+		StatusParser parse = streamStatusRequest(m_streams[i].url, &request);
+		if(!parse)
+			continue;
+
+		// a slow reply from the previous poll is dropped, like cancelUpdate() does
+		if(m_replies[i])
+			m_tasks.abort(m_replies[i]);
+
+		// the records don't move while polling, stop() cancels before they are replaced
+		m_replies[i] = m_tasks.get(request, [this, i, parse](QNetworkReply* reply) {
+			bool online;
+			int viewers;
+
+			m_replies[i] = nullptr;
+
+			if(reply->error() != QNetworkReply::NoError || !parse(reply->readAll(), &online, &viewers))
+				return;
+
+			StreamRecord& s = m_streams[i];
+			if(s.online == online && s.viewers == viewers)
+				return;
+
+			bool live = online && !s.online;
+			s.online = online;
+			s.viewers = viewers;
+
+			if(live)
+				emit wentLive(s.name, viewers);
+			emit statusChanged();
+		});
+	}
+}
+
+qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+	// size and resident pages
+	QFile statm("/proc/self/statm");
+	if(!statm.open(QIODevice::ReadOnly))
+		return -1;
+
+	QList<QByteArray> fields = statm.readAll().split(' ');
+	if(fields.size() < 2)
+		return -1;
+
+	return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+	return -1;
+#endif
+}
+
+void releaseFreeMemory()
+{
+#ifdef __GLIBC__
+	// glibc keeps freed heap pages mapped, the resident size would not move otherwise
+	malloc_trim(0);
+#endif
+}
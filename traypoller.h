@@ -0,0 +1,78 @@
+#ifndef TRAYPOLLER_H
+#define TRAYPOLLER_H
+
+#include <QObject>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "taskscope.h"
+
+/**
+ * @brief What's left of a stream row while the view is torn down
+ */
+struct StreamRecord {
+	QString url;
+	QString name;
+	QString quality;
+	int group; // index in the group records
+	bool online;
+	int viewers;
+};
+
+struct GroupRecord {
+	QString name;
+	int pollInterval;
+	bool expanded;
+	qint64 lastPoll; // ms, on the poller's clock
+};
+
+/**
+ * @brief Keeps polling the streams from compact records while the window sits in the tray
+ *
+ * Follows the same schedule as the view: expanded groups on the main update
+ * interval (if auto-update is on), collapsed groups on their own interval.
+ */
+class TrayPoller : public QObject
+{
+	Q_OBJECT
+
+	QVector<GroupRecord> m_groups;
+	QVector<StreamRecord> m_streams;
+	QVector<QNetworkReply*> m_replies; // in flight for each record, nullptr if none
+	TaskScope m_tasks;
+	QTimer m_timer;
+	QElapsedTimer m_clock;
+	int m_updateInterval; // seconds, 0: expanded groups aren't polled
+
+	void poll(int group);
+
+private slots:
+	void onTimer();
+
+signals:
+	void wentLive(QString const& name, int viewers);
+	void statusChanged();
+
+public:
+	explicit TrayPoller(QObject* parent = nullptr);
+
+	void start(QVector<GroupRecord> const& groups, QVector<StreamRecord> const& streams, int updateInterval);
+	void stop(); // cancels pending requests, the records are kept until clear()
+	void clear();
+
+	QVector<GroupRecord> const& getGroups() const;
+	QVector<StreamRecord> const& getStreams() const;
+	int onlineCount() const;
+};
+
+/**
+ * @brief Resident memory of the process in bytes, -1 where it can't be read
+ */
+qint64 residentMemory();
+
+/**
+ * @brief Hand memory freed by the allocator back to the system where possible
+ */
+void releaseFreeMemory();
+
+#endif // TRAYPOLLER_H
@@ -3,44 +3,72 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 
+QString twitchApiUrl()
+{
+	static const QString url = qEnvironmentVariableIsSet(TWITCH_API_ENV)
+			? QString::fromLocal8Bit(qgetenv(TWITCH_API_ENV))
+			: QString(TWITCH_API_URL);
+	return url;
+}
+
 QString TwitchStreamItem::getName() const
 {
-	return m_url.path().split("/", QString::SkipEmptyParts).first();
+	return channelName(m_url);
 }
 
-void TwitchStreamItem::replyFinished(QNetworkReply* reply)
+QString TwitchStreamItem::channelName(const QUrl& url)
+{
+	return url.path().split("/", QString::SkipEmptyParts).value(0);
+}
+
+QNetworkRequest TwitchStreamItem::statusRequest(const QString& name)
+{
+	return QNetworkRequest(QUrl(twitchApiUrl() + "/streams/" + name + "?client_id=" + TWITCH_CLIENT_ID));
+}
+
+bool TwitchStreamItem::parseStatus(const QByteArray& json, bool* online, int* viewerCount)
 {
-	if(reply->error() == QNetworkReply::NoError) {
-		QString strReply = (QString)reply->readAll();
-		QJsonDocument jsonResponse = QJsonDocument::fromJson(strReply.toUtf8());
-		QJsonObject jsonObject = jsonResponse.object();
-		QJsonValue stream = jsonObject.value("stream");
+	QJsonDocument jsonResponse = QJsonDocument::fromJson(json);
+	if(!jsonResponse.isObject())
+		return false;
 
-		m_online = false;
-		m_viewerCount = 0;
-		if(!stream.isNull() && !stream.isUndefined()) {
-			m_online = true;
-			m_viewerCount = stream.toObject()["viewers"].toInt();
-		}
+	QJsonValue stream = jsonResponse.object().value("stream");
 
-		updateWidgetItem();
+	*online = false;
+	*viewerCount = 0;
+	if(!stream.isNull() && !stream.isUndefined()) {
+		*online = true;
+		*viewerCount = stream.toObject()["viewers"].toInt();
 	}
 
-	delete reply;
+	return true;
+}
+
+void TwitchStreamItem::replyFinished(QNetworkReply* reply)
+{
+	bool online;
+	int viewerCount;
+
+	if(reply->error() == QNetworkReply::NoError && parseStatus(reply->readAll(), &online, &viewerCount)) {
+		setStatus(online, viewerCount);
+	}
+
+	emit updated();
 }
 
-TwitchStreamItem::TwitchStreamItem(QTreeWidget* parent, const QUrl& url, const QString& quality)
-	: StreamItem(parent, url, quality),
-	  m_netManager(this)
+TwitchStreamItem::TwitchStreamItem(QTreeWidgetItem* parent, const QUrl& url, const QString& quality)
+	: StreamItem(parent, url, quality)
 {
 	setIcon(COLUMN_ICON, QIcon(":twitch.ico"));
 	setText(COLUMN_NAME, getName());
-
-	connect(&m_netManager, &QNetworkAccessManager::finished, this, &TwitchStreamItem::replyFinished);
 }
 
 bool TwitchStreamItem::update()
 {
-	m_netManager.get(QNetworkRequest(QUrl("https://api.twitch.tv/kraken/streams/" + getName() + "?client_id=typums7x8lg9a0esmu4y7vyqitufa3")));
+	// still waiting on the previous cycle, don't stack requests
+	cancelUpdate();
+
+	m_pollTasks.get(statusRequest(getName()),
+					[this](QNetworkReply* reply) { replyFinished(reply); });
 	return true;
 }
@@ -2,22 +2,44 @@
 #define TWITCHSTREAM_H
 
 #include "stream.h"
-#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
 
 #define TWITCH_NAME "twitch.tv"
+#define TWITCH_API_URL "https://api.twitch.tv/kraken"
+#define TWITCH_API_ENV "LIVESTREAMERUI_TWITCH_API"
+#define TWITCH_CLIENT_ID "typums7x8lg9a0esmu4y7vyqitufa3"
+
+/**
+ * @brief Twitch API base url (can be overridden with LIVESTREAMERUI_TWITCH_API)
+ */
+QString twitchApiUrl();
 
 class TwitchStreamItem : public StreamItem
 {
-	QNetworkAccessManager m_netManager;
-
 private slots:
 	void replyFinished(QNetworkReply* reply);
 
 public:
-	TwitchStreamItem(QTreeWidget* parent, QUrl const& url, QString const& quality);
+	TwitchStreamItem(QTreeWidgetItem* parent, QUrl const& url, QString const& quality);
 
 	virtual bool update();
 	virtual QString getName() const;
+
+	/**
+	 * @brief Channel name of a stream url
+	 */
+	static QString channelName(QUrl const& url);
+
+	/**
+	 * @brief Status request for the channel <name>
+	 */
+	static QNetworkRequest statusRequest(QString const& name);
+
+	/**
+	 * @brief Parse a /streams/<name> API response
+	 * @return false if the json is invalid
+	 */
+	static bool parseStatus(QByteArray const& json, bool* online, int* viewerCount);
 };
 
 #endif // TWITCHSTREAM_H